@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "stats.h"
+
+// Les dades de cada bloc comencen just després de la capçalera, alineades
+#define BLOCK_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define BLOCK_DATA(b) ((char *)(b) + BLOCK_HEADER)
+
+void init_arena(Arena *a)
+{
+    a->first = NULL;
+    a->current = NULL;
+    a->last = 0;
+}
+
+// Bloc nou darrere de current. Cada bloc dobla l'anterior fins a
+// ARENA_MAX_BLOCK, de manera que n'hi ha pocs encara que l'arena creixi molt.
+static ArenaBlock *newBlock(Arena *a, size_t size)
+{
+    size_t blockSize = a->current != NULL ? 2 * a->current->size : ARENA_MIN_BLOCK;
+    blockSize = blockSize > ARENA_MAX_BLOCK ? ARENA_MAX_BLOCK : blockSize;
+    blockSize = blockSize < size ? size : blockSize;
+    ArenaBlock *b = malloc(BLOCK_HEADER + blockSize);
+    STATS_INC(STAT_MALLOCS);
+    if (b == NULL)
+    {
+        return NULL;
+    }
+    b->size = blockSize;
+    b->used = 0;
+    if (a->current == NULL)
+    {
+        b->next = a->first;
+        a->first = b;
+    }
+    else
+    {
+        b->next = a->current->next;
+        a->current->next = b;
+    }
+    return b;
+}
+
+void *arena_alloc(Arena *a, size_t size)
+{
+    STATS_INC(STAT_ARENA_ALLOCS);
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock *b = a->current != NULL ? a->current : a->first;
+    // Després d'un reset, els blocs següents es tornen a fer servir (i es
+    // buiden en aquest moment) abans de demanar-ne cap de nou
+    while (b != NULL && b->size - b->used < size)
+    {
+        b = b->next;
+        if (b != NULL)
+        {
+            b->used = 0;
+        }
+    }
+    if (b == NULL && (b = newBlock(a, size)) == NULL)
+    {
+        return NULL;
+    }
+    a->current = b;
+    a->last = b->used;
+    b->used += size;
+    return BLOCK_DATA(b) + a->last;
+}
+
+// Allarga una reserva. Si és l'última de l'arena i hi cap, creix al lloc;
+// si no, se'n fa una de nova i s'hi copia el contingut (l'antiga no es
+// recupera fins al reset).
+void *arena_grow(Arena *a, void *ptr, size_t old_size, size_t new_size)
+{
+    if (ptr != NULL && a->current != NULL && (char *)ptr == BLOCK_DATA(a->current) + a->last)
+    {
+        size_t size = (new_size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        if (a->last + size <= a->current->size)
+        {
+            STATS_INC(STAT_ARENA_ALLOCS);
+            a->current->used = a->last + size;
+            return ptr;
+        }
+    }
+    void *grown = arena_alloc(a, new_size);
+    if (grown != NULL && ptr != NULL)
+    {
+        memcpy(grown, ptr, old_size);
+    }
+    return grown;
+}
+
+void arena_reset(Arena *a)
+{
+    a->current = a->first;
+    a->last = 0;
+    if (a->first != NULL)
+    {
+        a->first->used = 0;
+    }
+}
+
+void clean_arena(Arena *a)
+{
+    ArenaBlock *b = a->first;
+    while (b != NULL)
+    {
+        ArenaBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+    init_arena(a);
+}
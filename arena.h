@@ -0,0 +1,34 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+
+// Arena: reserva per increment d'un punter dins de blocs grans. No
+// s'allibera res per separat; arena_reset() la buida sencera en O(1)
+// (els blocs es conserven per a la propera execució) i clean_arena()
+// retorna els blocs al sistema.
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK (64 << 10)
+#define ARENA_MAX_BLOCK (64 << 20)
+
+typedef struct _arenablock
+{
+    struct _arenablock *next;
+    size_t size;
+    size_t used;
+} ArenaBlock;
+
+typedef struct _arena
+{
+    ArenaBlock *first;
+    ArenaBlock *current;
+    size_t last;        // desplaçament de l'última reserva dins de current
+} Arena;
+
+void init_arena(Arena *a);
+void *arena_alloc(Arena *a, size_t size);
+void *arena_grow(Arena *a, void *ptr, size_t old_size, size_t new_size);
+void arena_reset(Arena *a);
+void clean_arena(Arena *a);
+
+#endif
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "process.h"
+#include "scheduler.h"
+#include "generator.h"
+#include "stats.h"
+
+#define OPTSTR "k:n:N:s:h"
+
+// Banc de proves del simulador: genera taules sintètiques de mida creixent
+// i executa cada algorisme/modalitat sense sortida. Cada execució es fa en
+// un procés fill perquè el pic de memòria (RSS) sigui el d'aquella sola
+// configuració. El resultat és una línia CSV per execució.
+
+// Perfil de càrrega: separació màxima entre arribades i ràfega màxima
+typedef struct _profile
+{
+    const char *name;
+    int max_gap;
+    int max_burst;
+} Profile;
+
+static const Profile profiles[] = {
+    {"dense-short", 1, 10},
+    {"dense-long", 1, 100},
+    {"sparse-short", 12, 10},
+    {"sparse-long", 120, 100},
+};
+
+static const char benchName[] = "P";
+
+static Process *generateWorkload(size_t nprocs, const Profile *profile, uint64_t seed)
+{
+    Process *procTable = malloc((nprocs > 0 ? nprocs : 1) * sizeof(Process));
+    if (procTable == NULL)
+    {
+        return NULL;
+    }
+    uint64_t state = seed != 0 ? seed : 1;
+    int arrive = 0;
+    for (size_t i = 0; i < nprocs; i++)
+    {
+        int burst = 1 + (int)(nextRandom(&state) % (uint64_t)profile->max_burst);
+        int priority = (int)(nextRandom(&state) % 10);
+        procTable[i] = initProcess((int)i, (char *)benchName, burst, priority, arrive);
+        arrive += (int)(nextRandom(&state) % (uint64_t)(profile->max_gap + 1));
+    }
+    return procTable;
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Executa una configuració i n'escriu la línia CSV. S'executa al fill.
+static int benchRun(size_t nprocs, const Profile *profile, const SimOptions *options, uint64_t seed)
+{
+    Process *procTable = generateWorkload(nprocs, profile, seed);
+    SimContext ctx;
+    if (procTable == NULL || init_context(&ctx, procTable, nprocs, options) != EXIT_SUCCESS)
+    {
+        free(procTable);
+        return EXIT_FAILURE;
+    }
+    stats_reset();
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = run_dispatcher(&ctx);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double wall = elapsed(&start, &end);
+    printf("%zu,%s,%s,%s,%d,%s,%zu,%zu,%.6f,%.0f,%.1f,%ld", nprocs, profile->name,
+           algorithm_name(options->algorithm), modalitiesNames[options->modality], options->quantum,
+           backendsNames[options->backend],
+           ctx.results.events, ctx.results.duration, wall,
+           wall > 0 ? (double)ctx.results.events / wall : 0.0,
+           ctx.results.events > 0 ? wall * 1e9 / (double)ctx.results.events : 0.0, usage.ru_maxrss);
+    // Comptadors del motor; buits si s'han compilat fora
+    const uint64_t *c = simStats.counters;
+    if (stats_enabled())
+    {
+        printf(",%llu,%llu,%llu,%llu,%llu,%.3f\n", (unsigned long long)c[STAT_SKIPPED],
+               (unsigned long long)(c[STAT_ENQUEUES] + c[STAT_HEAP_PUSHES] + c[STAT_READY_PUSHES]),
+               (unsigned long long)c[STAT_DISPATCHES], (unsigned long long)c[STAT_PREEMPTIONS] + c[STAT_SLICE_ENDS],
+               (unsigned long long)c[STAT_MALLOCS], stats_allocs_per_proc(&simStats, nprocs));
+    }
+    else
+    {
+        printf(",,,,,,\n");
+    }
+    fflush(stdout);
+
+    clean_context(&ctx);
+    free(procTable);
+    return status;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+      " usage:\n"
+      "    ./schedbench [-n min] [-N max] [-s seed] [-k backend]\n"
+      "       -n min:   smallest table (default 100)\n"
+      "       -N max:   largest table (default 10000000); sizes grow by 10x\n"
+      "       -s seed:  random seed of the generated tables (default 1)\n"
+      "       -k [heap,scalar,simd,all]:  ready queue of sjf/priorities (default heap)\n"
+      "    output: one CSV line per run; rss in KB. The engine counters (skipped instants,\n"
+      "    ready queue pushes, dispatches, requeues, mallocs, allocations per process) are\n"
+      "    empty when built with STATS=0\n"
+      "\n");
+}
+
+int main(int argc, char *argv[])
+{
+    size_t minProcs = 100;
+    size_t maxProcs = 10000000;
+    uint64_t seed = 1;
+    int quantum = 4;
+    int backend = BACKEND_HEAP;
+
+    int opt;
+    while ((opt = getopt(argc, argv, OPTSTR)) != EOF)
+    {
+        switch (opt)
+        {
+        case 'n':
+            minProcs = strtoul(optarg, NULL, 10);
+            break;
+        case 'N':
+            maxProcs = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'k':
+            backend = -2;
+            for (int i = 0; i < num_backends(); i++)
+            {
+                if (strcmp(optarg, backendsNames[i]) == 0)
+                {
+                    backend = i;
+                }
+            }
+            backend = strcmp(optarg, "all") == 0 ? -1 : backend;
+            if (backend == -2)
+            {
+                fprintf(stderr, "No such backend: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            usage();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (minProcs == 0 || maxProcs < minProcs)
+    {
+        fprintf(stderr, "Invalid size range: %zu..%zu\n", minProcs, maxProcs);
+        return EXIT_FAILURE;
+    }
+
+    printf("nprocs,profile,algorithm,modality,quantum,backend,events,duration,wall_s,events_per_s,ns_per_event,rss_kb,"
+           "skipped,pushes,dispatches,requeues,mallocs,allocs_per_proc\n");
+    fflush(stdout);
+    int status = EXIT_SUCCESS;
+    for (size_t n = minProcs; n <= maxProcs; n *= 10)
+    {
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(Profile); p++)
+        {
+            for (int a = 0; a < num_algorithms(); a++)
+            {
+                for (int m = 0; m < num_modalities(); m++)
+                {
+                    // Només les modalitats que admet la política
+                    if (!policy_accepts(get_policy(a), m))
+                    {
+                        continue;
+                    }
+                    // El backend només canvia la cua de SJF/Prioritats
+                    for (int k = 0; k < num_backends(); k++)
+                    {
+                        if ((backend >= 0 || (a != SJF && a != PRIORITIES)) && k != (backend >= 0 ? backend : BACKEND_HEAP))
+                        {
+                            continue;
+                        }
+                        SimOptions options = {a, m, get_policy(a)->quantum ? quantum : 0, {1, PLACE_LEAST, BALANCE_STEAL}, true};
+                        options.backend = k;
+                        options.seed = seed;
+                        pid_t pid = fork();
+                        if (pid == 0)
+                        {
+                            exit(benchRun(n, &profiles[p], &options, seed));
+                        }
+                        int wstatus = 0;
+                        if (pid < 0 || waitpid(pid, &wstatus, 0) < 0 || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != EXIT_SUCCESS)
+                        {
+                            fprintf(stderr, "%zu,%s,%s,%s,%s: failed\n", n, profiles[p].name, algorithm_name(a),
+                                    modalitiesNames[m], backendsNames[k]);
+                            status = EXIT_FAILURE;
+                        }
+                    }
+                }
+            }
+        }
+        if (n > maxProcs / 10)
+        {
+            break;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,245 @@
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+#include "policy.h"
+#include "rbtree.h"
+
+// Planificador just a l'estil de CFS. Cada procés acumula temps virtual
+// (el temps executat dividit pel seu pes) i cada CPU executa el preparat
+// amb menys temps virtual, el primer d'un arbre roig-negre.
+//
+// El pes surt de la prioritat com el nice de Linux (policy_weight()).
+// Cada tram és la part del període que correspon al pes del procés sobre
+// el total de preparats de la CPU; el període és CFS_LATENCY
+// o, amb molts preparats, CFS_MIN_GRANULARITY per procés. En mode
+// preemptiu, un procés amb prou menys temps virtual expulsa el que
+// s'executa sense esperar el final del tram.
+#define CFS_LATENCY 24
+#define CFS_MIN_GRANULARITY 3
+#define CFS_WAKEUP_GRANULARITY 2
+#define NICE_0_WEIGHT 1024
+#define VRUNTIME_SHIFT 10   // el temps virtual es compta en 1/1024 d'unitat
+
+typedef struct _cfs
+{
+    RBNode *nodes;              // nodes compartits pels arbres de les CPUs
+    RBTree *trees;              // preparats de cada CPU per temps virtual
+    long long *min_vruntime;    // per CPU: mínim monòton dels temps virtuals
+    long long *load;            // per CPU: suma dels pesos dels preparats
+    long long *vruntime;        // per procés (posició a la taula)
+    int *home;                  // CPU a la qual es refereix vruntime, o -1
+} Cfs;
+
+static long long virtualTime(int ran, int w)
+{
+    return ((long long)ran << VRUNTIME_SHIFT) * NICE_0_WEIGHT / w;
+}
+
+static void cfsClean(SimContext *ctx)
+{
+    Cfs *cfs = ctx->policy_state;
+    if (cfs == NULL)
+    {
+        return;
+    }
+    free(cfs->nodes);
+    free(cfs->trees);
+    free(cfs->min_vruntime);
+    free(cfs->load);
+    free(cfs->vruntime);
+    free(cfs->home);
+    free(cfs);
+    ctx->policy_state = NULL;
+}
+
+static int cfsInit(SimContext *ctx)
+{
+    size_t ncpus = (size_t)ctx->ncpus;
+    size_t nprocs = ctx->nprocs > 0 ? ctx->nprocs : 1;
+    Cfs *cfs = calloc(1, sizeof(Cfs));
+    ctx->policy_state = cfs;
+    if (cfs == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    cfs->nodes = init_rbtree_nodes(ctx->nprocs);
+    cfs->trees = calloc(ncpus, sizeof(RBTree));
+    cfs->min_vruntime = calloc(ncpus, sizeof(long long));
+    cfs->load = calloc(ncpus, sizeof(long long));
+    cfs->vruntime = calloc(nprocs, sizeof(long long));
+    cfs->home = calloc(nprocs, sizeof(int));
+    if (cfs->nodes == NULL || cfs->trees == NULL || cfs->min_vruntime == NULL || cfs->load == NULL ||
+        cfs->vruntime == NULL || cfs->home == NULL)
+    {
+        cfsClean(ctx);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int cfsStart(SimContext *ctx)
+{
+    Cfs *cfs = ctx->policy_state;
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        init_rbtree(&cfs->trees[c], cfs->nodes, ctx->nprocs);
+        cfs->min_vruntime[c] = 0;
+        cfs->load[c] = 0;
+    }
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        cfs->vruntime[p] = 0;
+        cfs->home[p] = -1;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Els temps virtuals de cada CPU avancen per separat: un procés que canvia
+// de CPU conserva la seva distància al mínim de la CPU d'origen
+static void migrate(Cfs *cfs, size_t order, int cpu)
+{
+    if (cfs->home[order] >= 0 && cfs->home[order] != cpu)
+    {
+        cfs->vruntime[order] += cfs->min_vruntime[cpu] - cfs->min_vruntime[cfs->home[order]];
+    }
+    cfs->home[order] = cpu;
+}
+
+// El mínim no retrocedeix mai: avança fins al menor entre el procés en
+// execució i el primer de l'arbre
+static void updateMin(Cfs *cfs, CPU *c, long long current)
+{
+    RBTree *tree = &cfs->trees[c->id];
+    size_t first = rbtree_first(tree);
+    if (first != RB_NONE && rbtree_key(tree, first) < current)
+    {
+        current = rbtree_key(tree, first);
+    }
+    if (current > cfs->min_vruntime[c->id])
+    {
+        cfs->min_vruntime[c->id] = current;
+    }
+}
+
+static void enqueueProcess(Cfs *cfs, CPU *c, Process *p, size_t order)
+{
+    rbtree_insert(&cfs->trees[c->id], order, cfs->vruntime[order]);
+    cfs->load[c->id] += policy_weight(p);
+}
+
+// Un procés nou comença al mínim de la CPU; un que torna de l'E/S recupera
+// com a molt mig període del temps que ha estat bloquejat. El motor ja ha
+// comptat el que ha executat el procés en curs fins ara (on_tick), de
+// manera que el mínim l'inclou.
+static int cfsArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    Cfs *cfs = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    long long min = cfs->min_vruntime[c->id];
+    if (cfs->home[order] < 0)
+    {
+        cfs->vruntime[order] = min;
+    }
+    else
+    {
+        migrate(cfs, order, c->id);
+        long long floor = min - ((long long)CFS_LATENCY << VRUNTIME_SHIFT) / 2;
+        cfs->vruntime[order] = cfs->vruntime[order] > floor ? cfs->vruntime[order] : floor;
+    }
+    cfs->home[order] = c->id;
+    enqueueProcess(cfs, c, p, order);
+    return EXIT_SUCCESS;
+}
+
+static int cfsPreempt(SimContext *ctx, CPU *c, Process *p)
+{
+    Cfs *cfs = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    migrate(cfs, order, c->id);
+    enqueueProcess(cfs, c, p, order);
+    return EXIT_SUCCESS;
+}
+
+// El tram és la part del període proporcional al pes, sobre els preparats
+// de la CPU més el triat
+static Process *cfsPick(SimContext *ctx, CPU *c, int *slice)
+{
+    Cfs *cfs = ctx->policy_state;
+    RBTree *tree = &cfs->trees[c->id];
+    size_t order = rbtree_first(tree);
+    if (order == RB_NONE)
+    {
+        return NULL;
+    }
+    Process *p = &ctx->procTable[order];
+    int w = policy_weight(p);
+    rbtree_remove(tree, order);
+    cfs->load[c->id] -= w;
+    updateMin(cfs, c, cfs->vruntime[order]);
+
+    long long running = (long long)rbtree_size(tree) + 1;
+    long long period = running * CFS_MIN_GRANULARITY > CFS_LATENCY ? running * CFS_MIN_GRANULARITY : CFS_LATENCY;
+    long long share = period * w / (cfs->load[c->id] + w);
+    *slice = share > 0 ? (int)share : 1;
+    return p;
+}
+
+static void cfsTick(SimContext *ctx, CPU *c, Process *p, int ran)
+{
+    Cfs *cfs = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    migrate(cfs, order, c->id);
+    cfs->vruntime[order] += virtualTime(ran, policy_weight(p));
+    updateMin(cfs, c, cfs->vruntime[order]);
+}
+
+// Expulsa si el primer porta més d'una granularitat (mesurada amb el seu
+// pes) de temps virtual per darrere del que s'executa
+static bool cfsPreempts(SimContext *ctx, CPU *c, Process *running)
+{
+    Cfs *cfs = ctx->policy_state;
+    if (ctx->options.modality != PREEMPTIVE)
+    {
+        return false;
+    }
+    RBTree *tree = &cfs->trees[c->id];
+    size_t first = rbtree_first(tree);
+    if (first == RB_NONE)
+    {
+        return false;
+    }
+    long long lead = cfs->vruntime[running - ctx->procTable] - rbtree_key(tree, first);
+    return lead > virtualTime(CFS_WAKEUP_GRANULARITY, policy_weight(&ctx->procTable[first]));
+}
+
+// Un procés que acaba del tot deixa la posició com un de nou: a
+// l'arribada començarà al mínim de la CPU
+static void cfsComplete(SimContext *ctx, CPU *c, Process *p)
+{
+    Cfs *cfs = ctx->policy_state;
+    if (p->completed)
+    {
+        cfs->home[p - ctx->procTable] = -1;
+    }
+}
+
+static size_t cfsSize(SimContext *ctx, CPU *c)
+{
+    Cfs *cfs = ctx->policy_state;
+    return rbtree_size(&cfs->trees[c->id]);
+}
+
+const Policy cfsPolicy = {
+    .name = "cfs",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .init = cfsInit,
+    .start = cfsStart,
+    .clean = cfsClean,
+    .on_arrival = cfsArrival,
+    .pick_next = cfsPick,
+    .on_tick = cfsTick,
+    .preempts = cfsPreempts,
+    .on_preempt = cfsPreempt,
+    .on_complete = cfsComplete,
+    .size = cfsSize,
+};
@@ -0,0 +1,52 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fenwick.h"
+
+int init_fenwick(Fenwick* f, size_t n){
+    f->tree = calloc(n + 1, sizeof(long long));
+    f->n = n;
+    f->top = 1;
+    while (f->top * 2 <= n){
+        f->top *= 2;
+    }
+    f->total = 0;
+    return f->tree != NULL ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void reset_fenwick(Fenwick* f){
+    memset(f->tree, 0, (f->n + 1) * sizeof(long long));
+    f->total = 0;
+}
+
+// Suma delta al pes de la posició i (0..n-1)
+void fenwick_add(Fenwick* f, size_t i, long long delta){
+    f->total += delta;
+    for (i++; i <= f->n; i += i & (~i + 1)){
+        f->tree[i] += delta;
+    }
+}
+
+// Posició on cau target (0 <= target < total): la primera amb suma
+// acumulada més gran que target. Es baixa per les potències de 2 en lloc
+// de fer una cerca binària sobre les sumes.
+size_t fenwick_find(Fenwick* f, long long target){
+    size_t pos = 0;
+    for (size_t step = f->top; step > 0 && f->n > 0; step >>= 1){
+        if (pos + step <= f->n && f->tree[pos + step] <= target){
+            pos += step;
+            target -= f->tree[pos];
+        }
+    }
+    return pos;
+}
+
+long long fenwick_total(Fenwick* f){
+    return f->total;
+}
+
+void clean_fenwick(Fenwick* f){
+    free(f->tree);
+    f->tree = NULL;
+    f->n = 0;
+    f->total = 0;
+}
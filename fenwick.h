@@ -0,0 +1,24 @@
+#ifndef _FENWICK_H_
+#define _FENWICK_H_
+
+#include <stddef.h>
+
+// Arbre de Fenwick (binary indexed tree) de pesos no negatius per posició:
+// sumar a una posició i trobar la posició on cau un valor acumulat són
+// O(log n), i el total és O(1).
+typedef struct _fenwick
+{
+    long long* tree;    // tree[1..n]
+    size_t n;
+    size_t top;         // potència de 2 més gran que no supera n
+    long long total;
+} Fenwick;
+
+int init_fenwick(Fenwick* f, size_t n);
+void reset_fenwick(Fenwick* f);
+void fenwick_add(Fenwick* f, size_t i, long long delta);
+size_t fenwick_find(Fenwick* f, long long target);
+long long fenwick_total(Fenwick* f);
+void clean_fenwick(Fenwick* f);
+
+#endif
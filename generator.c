@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "generator.h"
+
+// Noms dels paràmetres de cada distribució (NULL si no en té segon)
+static const char * const paramNames[][2] = {
+    [DIST_POISSON] = {"lambda", NULL},
+    [DIST_BURSTY] = {"lambda", "size"},
+    [DIST_EXP] = {"mean", NULL},
+    [DIST_LOGNORMAL] = {"mu", "sigma"},
+    [DIST_PARETO] = {"alpha", "xm"},
+    [DIST_UNIFORM] = {"min", "max"},
+};
+
+static const double paramDefaults[][2] = {
+    [DIST_POISSON] = {0.08, 0},
+    [DIST_BURSTY] = {0.01, 8},
+    [DIST_EXP] = {10, 0},
+    [DIST_LOGNORMAL] = {2, 1},
+    [DIST_PARETO] = {1.5, 4},
+    [DIST_UNIFORM] = {0, 9},
+};
+
+int num_distributions()
+{
+    return sizeof(distributionsNames) / sizeof(char *);
+}
+
+uint64_t nextRandom(uint64_t *state)
+{
+    // xorshift64*: ràpid i reproduïble a partir de la llavor
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+// Uniforme a (0, 1]: mai és 0, de manera que log(u) és finit
+static double uniform01(uint64_t *state)
+{
+    return (double)((nextRandom(state) >> 11) + 1) * 0x1.0p-53;
+}
+
+static double sample(const Distribution *d, uint64_t *state)
+{
+    double u = uniform01(state);
+    switch (d->kind)
+    {
+    case DIST_POISSON:
+    case DIST_BURSTY:
+        // Temps entre arribades (o entre ràfegues d'arribades)
+        return -log(u) / d->param[0];
+    case DIST_EXP:
+        return -d->param[0] * log(u);
+    case DIST_LOGNORMAL:
+    {
+        // Box-Muller
+        double z = sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniform01(state));
+        return exp(d->param[0] + d->param[1] * z);
+    }
+    case DIST_PARETO:
+        return d->param[1] / pow(u, 1.0 / d->param[0]);
+    case DIST_UNIFORM:
+    default:
+        return d->param[0] + floor((1.0 - u) * (d->param[1] - d->param[0] + 1));
+    }
+}
+
+static int toInt(double x, int min)
+{
+    if (!(x < INT_MAX / 2))
+    {
+        return INT_MAX / 2;
+    }
+    return x < min ? min : (int)x;
+}
+
+static void setDistribution(Distribution *d, int kind)
+{
+    d->kind = kind;
+    d->param[0] = paramDefaults[kind][0];
+    d->param[1] = paramDefaults[kind][1];
+}
+
+// Fixa el paràmetre name=value de d
+static int setParam(Distribution *d, const char *name, const char *value)
+{
+    for (int p = 0; p < 2; p++)
+    {
+        if (paramNames[d->kind][p] != NULL && strcmp(name, paramNames[d->kind][p]) == 0)
+        {
+            char *end;
+            d->param[p] = strtod(value, &end);
+            return *value != '\0' && *end == '\0' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    return EXIT_FAILURE;
+}
+
+// Llegeix "kind[:param=value|:min..max]" a d
+static int parseDistribution(char *s, Distribution *d)
+{
+    char *params = strchr(s, ':');
+    if (params != NULL)
+    {
+        *params++ = '\0';
+    }
+    int kind = -1;
+    for (int i = 0; i < num_distributions(); i++)
+    {
+        if (strcmp(s, distributionsNames[i]) == 0)
+        {
+            kind = i;
+        }
+    }
+    if (kind < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    setDistribution(d, kind);
+    if (params == NULL)
+    {
+        return EXIT_SUCCESS;
+    }
+    char *range = strstr(params, "..");
+    if (kind == DIST_UNIFORM && range != NULL)
+    {
+        *range = '\0';
+        return setParam(d, "min", params) == EXIT_SUCCESS ? setParam(d, "max", range + 2) : EXIT_FAILURE;
+    }
+    char *value = strchr(params, '=');
+    if (value == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    *value++ = '\0';
+    return setParam(d, params, value);
+}
+
+static bool validDistribution(const Distribution *d)
+{
+    switch (d->kind)
+    {
+    case DIST_POISSON:
+        return d->param[0] > 0;
+    case DIST_BURSTY:
+        return d->param[0] > 0 && d->param[1] >= 1;
+    case DIST_EXP:
+        return d->param[0] > 0;
+    case DIST_LOGNORMAL:
+        return d->param[1] >= 0;
+    case DIST_PARETO:
+        return d->param[0] > 0 && d->param[1] > 0;
+    default:
+        return d->param[1] >= d->param[0];
+    }
+}
+
+// Llegeix una especificació com
+//   poisson:lambda=0.1,burst=lognormal:mu=2,sigma=1,prio=uniform:0..9,n=1000,seed=7
+// Els elements separats per comes són claus (arrival, burst, prio, io,
+// cycles, n, seed),
+// la distribució d'arribades directament, o un paràmetre addicional de la
+// darrera distribució indicada (com sigma a l'exemple).
+int parseGenerator(const char *spec, Generator *gen)
+{
+    memset(gen, 0, sizeof(Generator));
+    setDistribution(&gen->arrival, DIST_POISSON);
+    setDistribution(&gen->burst, DIST_EXP);
+    setDistribution(&gen->priority, DIST_UNIFORM);
+    setDistribution(&gen->io, DIST_EXP);
+    gen->cycles = 1;
+    gen->nprocs = 1000;
+    gen->seed = 1;
+
+    char *copy = strdup(spec);
+    if (copy == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    int status = EXIT_SUCCESS;
+    Distribution *last = NULL;
+    char *saveptr = NULL;
+    for (char *item = strtok_r(copy, ",", &saveptr); item != NULL && status == EXIT_SUCCESS; item = strtok_r(NULL, ",", &saveptr))
+    {
+        char *eq = strchr(item, '=');
+        char *colon = strchr(item, ':');
+        if (colon != NULL && (eq == NULL || colon < eq))
+        {
+            last = &gen->arrival;
+            status = parseDistribution(item, last);
+            continue;
+        }
+        if (eq == NULL)
+        {
+            status = EXIT_FAILURE;
+            break;
+        }
+        *eq = '\0';
+        char *value = eq + 1;
+        char *end = NULL;
+        if (strcmp(item, "arrival") == 0 || strcmp(item, "burst") == 0 || strcmp(item, "prio") == 0 || strcmp(item, "io") == 0)
+        {
+            last = item[0] == 'a' ? &gen->arrival : item[0] == 'b' ? &gen->burst : item[0] == 'p' ? &gen->priority : &gen->io;
+            status = parseDistribution(value, last);
+        }
+        else if (strcmp(item, "cycles") == 0)
+        {
+            long cycles = strtol(value, &end, 10);
+            gen->cycles = cycles >= 1 && cycles <= GENERATOR_MAX_CYCLES ? (int)cycles : 0;
+        }
+        else if (strcmp(item, "n") == 0)
+        {
+            gen->nprocs = strtoul(value, &end, 10);
+        }
+        else if (strcmp(item, "seed") == 0)
+        {
+            gen->seed = strtoull(value, &end, 10);
+        }
+        else if (last != NULL)
+        {
+            // Paràmetre addicional de la darrera distribució
+            status = setParam(last, item, value);
+        }
+        else
+        {
+            status = EXIT_FAILURE;
+        }
+        if (end != NULL && (end == value || *end != '\0'))
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+    free(copy);
+
+    if (status != EXIT_SUCCESS
+        || (gen->arrival.kind != DIST_POISSON && gen->arrival.kind != DIST_BURSTY)
+        || gen->burst.kind == DIST_POISSON || gen->burst.kind == DIST_BURSTY
+        || gen->priority.kind == DIST_POISSON || gen->priority.kind == DIST_BURSTY
+        || gen->io.kind == DIST_POISSON || gen->io.kind == DIST_BURSTY || gen->cycles < 1
+        || !validDistribution(&gen->arrival) || !validDistribution(&gen->burst) || !validDistribution(&gen->priority)
+        || !validDistribution(&gen->io))
+    {
+        fprintf(stderr, "Invalid generator spec: %s\n", spec);
+        return EXIT_FAILURE;
+    }
+    resetGenerator(gen);
+    return EXIT_SUCCESS;
+}
+
+void resetGenerator(Generator *gen)
+{
+    gen->state = gen->seed != 0 ? gen->seed : 1;
+    gen->clock = 0;
+    gen->pending = 0;
+    gen->produced = 0;
+    gen->work = 0;
+    gen->overflow = false;
+}
+
+// Produeix el següent procés en ordre d'arribada. bursts (amb lloc per a
+// 2 * cycles - 1 ràfegues) rep la seqüència CPU, E/S, CPU... El nom i la
+// seqüència queden fora del procés: és qui el guarda qui els hi assigna.
+// Cap simulació acaba més tard que l'última arribada més tota la feina
+// (CPU i E/S); si això no cap en un int, el generador s'atura i marca
+// overflow.
+bool nextProcess(Generator *gen, Process *proc, int *bursts)
+{
+    if (gen->produced >= gen->nprocs || gen->overflow)
+    {
+        return false;
+    }
+    if (gen->pending == 0)
+    {
+        // El primer procés arriba a l'instant 0
+        if (gen->produced > 0)
+        {
+            gen->clock += sample(&gen->arrival, &gen->state);
+        }
+        gen->pending = 1;
+        if (gen->arrival.kind == DIST_BURSTY && gen->arrival.param[1] > 1)
+        {
+            // Mida geomètrica de mitjana size
+            double u = uniform01(&gen->state);
+            gen->pending += (size_t)floor(log(u) / log(1.0 - 1.0 / gen->arrival.param[1]));
+        }
+    }
+    gen->pending--;
+
+    int id = (int)gen->produced;
+    int nbursts = 2 * gen->cycles - 1;
+    for (int k = 0; k < nbursts; k++)
+    {
+        bursts[k] = k % 2 == 0 ? toInt(ceil(sample(&gen->burst, &gen->state)), 1)
+                               : toInt(ceil(sample(&gen->io, &gen->state)), 0);
+        gen->work += bursts[k];
+    }
+    if (gen->clock + gen->work >= INT_MAX)
+    {
+        gen->overflow = true;
+        return false;
+    }
+    int priority = toInt(sample(&gen->priority, &gen->state), INT_MIN / 2);
+    *proc = initProcess(id, NULL, bursts[0], priority, toInt(gen->clock, 0));
+    gen->produced++;
+    return true;
+}
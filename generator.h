@@ -0,0 +1,60 @@
+#ifndef _GENERATOR_H_
+#define _GENERATOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "process.h"
+
+// Distribucions disponibles. poisson i bursty descriuen arribades; la
+// resta, ràfegues o prioritats.
+enum distributions{DIST_POISSON, DIST_BURSTY, DIST_EXP, DIST_LOGNORMAL, DIST_PARETO, DIST_UNIFORM};
+static const char * const distributionsNames[] = {
+	[DIST_POISSON] = "poisson",
+	[DIST_BURSTY] = "bursty",
+	[DIST_EXP] = "exp",
+	[DIST_LOGNORMAL] = "lognormal",
+	[DIST_PARETO] = "pareto",
+	[DIST_UNIFORM] = "uniform",
+};
+
+// Cada distribució té fins a dos paràmetres, amb aquests noms:
+//   poisson:lambda   bursty:lambda,size   exp:mean
+//   lognormal:mu,sigma   pareto:alpha,xm   uniform:min..max
+typedef struct _distribution
+{
+    int kind;
+    double param[2];
+} Distribution;
+
+#define GENERATOR_MAX_CYCLES 512
+
+// Generador de processos en ordre d'arribada. No guarda cap taula: cada
+// crida a nextProcess() en produeix un de nou a partir de l'estat actual.
+// Qui el consumeix la construeix (loadGeneratedWorkload()) o en guarda
+// només els processos vius (ProcStream, stream.h).
+typedef struct _generator
+{
+    Distribution arrival;
+    Distribution burst;
+    Distribution priority;
+    Distribution io;
+    int cycles;         // ràfegues de CPU per procés, separades per E/S
+    size_t nprocs;
+    uint64_t seed;
+    // Estat
+    uint64_t state;
+    double clock;
+    size_t pending;     // processos que queden de la ràfaga d'arribades actual
+    size_t produced;
+    double work;        // suma de les ràfegues (CPU i E/S) produïdes
+    bool overflow;      // la càrrega no cap al rellotge de la simulació
+} Generator;
+
+int num_distributions(void);
+uint64_t nextRandom(uint64_t *state);
+int parseGenerator(const char *spec, Generator *gen);
+void resetGenerator(Generator *gen);
+bool nextProcess(Generator *gen, Process *proc, int *bursts);
+
+#endif
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "heap.h"
+#include "process.h"
+#include "stats.h"
+
+int remainingKey(Process *p){
+    return p->remaining;
+}
+
+int priorityKey(Process *p){
+    return p->priority;
+}
+
+int wakeupKey(Process *p){
+    return p->wakeup;
+}
+
+// EDF: termini absolut del treball en curs; sense termini, al final
+int deadlineKey(Process *p){
+    return p->deadline > 0 ? p->release + p->deadline : INT_MAX;
+}
+
+// Rate-monotonic: prioritat fixa, més alta com més curt és el període (o,
+// si és aperiòdica, el termini)
+int rateKey(Process *p){
+    return p->period > 0 ? p->period : p->deadline > 0 ? p->deadline : INT_MAX;
+}
+
+// a va abans que b: clau menor i, en cas d'empat, arribada anterior
+static bool heap_less(HeapNode* a, HeapNode* b){
+    return a->key < b->key || (a->key == b->key && a->order < b->order);
+}
+
+static void heap_place(Heap* h, size_t i, HeapNode node){
+    h->nodes[i] = node;
+    h->position[node.order] = i;
+}
+
+static void sift_up(Heap* h, size_t i){
+    HeapNode node = h->nodes[i];
+    while (i > 0){
+        size_t parent = (i - 1) / 2;
+        if (!heap_less(&node, &h->nodes[parent])){
+            break;
+        }
+        heap_place(h, i, h->nodes[parent]);
+        i = parent;
+    }
+    heap_place(h, i, node);
+}
+
+static void sift_down(Heap* h, size_t i){
+    HeapNode node = h->nodes[i];
+    for (;;){
+        size_t child = 2 * i + 1;
+        if (child >= h->size){
+            break;
+        }
+        if (child + 1 < h->size && heap_less(&h->nodes[child + 1], &h->nodes[child])){
+            child++;
+        }
+        if (!heap_less(&h->nodes[child], &node)){
+            break;
+        }
+        heap_place(h, i, h->nodes[child]);
+        i = child;
+    }
+    heap_place(h, i, node);
+}
+
+#define HEAP_MIN_CAPACITY 16
+
+size_t* init_heap_positions(size_t nprocs){
+    size_t* position = malloc((nprocs > 0 ? nprocs : 1) * sizeof(size_t));
+    if (position != NULL){
+        for (size_t i = 0; i < nprocs; i++){
+            position[i] = HEAP_NONE;
+        }
+    }
+    return position;
+}
+
+// Si position és NULL el montícle en reserva un de propi
+int init_heap(Heap* h, Process* base, size_t nprocs, heap_key key, size_t* position){
+    h->owns_position = (position == NULL);
+    h->position = position != NULL ? position : init_heap_positions(nprocs);
+    h->capacity = nprocs < HEAP_MIN_CAPACITY ? nprocs : HEAP_MIN_CAPACITY;
+    h->nodes = malloc((h->capacity > 0 ? h->capacity : 1) * sizeof(HeapNode));
+    if (h->nodes == NULL || h->position == NULL){
+        free(h->nodes);
+        if (h->owns_position){
+            free(h->position);
+        }
+        return EXIT_FAILURE;
+    }
+    h->size = 0;
+    h->nprocs = nprocs;
+    h->base = base;
+    h->key = key;
+    return EXIT_SUCCESS;
+}
+
+size_t heap_size(Heap* h){
+    return h->size;
+}
+
+bool heap_contains(Heap* h, Process* p){
+    return h->position[(size_t)(p - h->base)] != HEAP_NONE;
+}
+
+// a va abans que b segons la clau actual de tots dos (p.ex. per decidir si
+// el primer del montícle ha d'expulsar el procés en execució)
+bool heap_before(Heap* h, Process* a, Process* b){
+    HeapNode na = {h->key(a), (size_t)(a - h->base), a};
+    HeapNode nb = {h->key(b), (size_t)(b - h->base), b};
+    return heap_less(&na, &nb);
+}
+
+int heap_push(Heap* h, Process* p){
+    return heap_push_key(h, p, h->key(p));
+}
+
+// Com heap_push(), amb la clau ja calculada per qui crida (p.ex. un bucle
+// que coneix la clau en temps de compilació i no passa pel punter h->key)
+int heap_push_key(Heap* h, Process* p, int key){
+    size_t order = (size_t)(p - h->base);
+    if (order >= h->nprocs || h->position[order] != HEAP_NONE){
+        return EXIT_FAILURE;
+    }
+    if (h->size == h->capacity){
+        size_t capacity = h->capacity > 0 ? 2 * h->capacity : HEAP_MIN_CAPACITY;
+        HeapNode* nodes = realloc(h->nodes, capacity * sizeof(HeapNode));
+        if (nodes == NULL){
+            return EXIT_FAILURE;
+        }
+        STATS_INC(STAT_HEAP_GROWS);
+        STATS_INC(STAT_MALLOCS);
+        h->nodes = nodes;
+        h->capacity = capacity;
+    }
+    HeapNode node = {key, order, p};
+    h->nodes[h->size] = node;
+    h->size++;
+    STATS_INC(STAT_HEAP_PUSHES);
+    sift_up(h, h->size - 1);
+    return EXIT_SUCCESS;
+}
+
+Process* heap_peek(Heap* h){
+    return h->size > 0 ? h->nodes[0].process : NULL;
+}
+
+Process* heap_pop(Heap* h){
+    if (h->size == 0){
+        return NULL;
+    }
+    HeapNode top = h->nodes[0];
+    h->position[top.order] = HEAP_NONE;
+    STATS_INC(STAT_HEAP_POPS);
+    h->size--;
+    if (h->size > 0){
+        h->nodes[0] = h->nodes[h->size];
+        sift_down(h, 0);
+    }
+    return top.process;
+}
+
+// Recalcula la clau de p (p.ex. després d'executar-se) i el recol·loca
+int heap_update(Heap* h, Process* p){
+    size_t i = h->position[(size_t)(p - h->base)];
+    if (i == HEAP_NONE){
+        return EXIT_FAILURE;
+    }
+    int key = h->key(p);
+    int old = h->nodes[i].key;
+    h->nodes[i].key = key;
+    if (key < old){
+        sift_up(h, i);
+    } else if (key > old){
+        sift_down(h, i);
+    }
+    return EXIT_SUCCESS;
+}
+
+void clean_heap(Heap* h){
+    free(h->nodes);
+    if (h->owns_position){
+        free(h->position);
+    }
+    h->nodes = NULL;
+    h->position = NULL;
+    h->size = 0;
+    h->capacity = 0;
+}
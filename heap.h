@@ -0,0 +1,54 @@
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include <stddef.h>
+#include "process.h"
+
+# define HEAP_NONE ((size_t)-1)
+
+// Clau d'ordenació d'un procés dins del montícle (menor = més prioritari)
+typedef int (*heap_key)(Process *p);
+
+typedef struct _heap_node
+{
+    int key;        // clau en el moment de l'última inserció/actualització
+    size_t order;   // ordre d'arribada (posició a la taula), desempat determinista
+    Process* process;
+} HeapNode;
+
+// Montícle binari indexat. Cada procés de la taula base té una posició
+// coneguda dins del montícle, de manera que es pot actualitzar la seva
+// clau (decrease-key) en O(log n) sense buscar-lo. Diversos montícles
+// poden compartir el vector de posicions si cada procés només pot estar
+// en un d'ells alhora (p.ex. una cua per CPU).
+typedef struct _heap
+{
+    HeapNode* nodes;
+    size_t* position;  // position[order] = índex a nodes, o HEAP_NONE
+    bool owns_position;
+    size_t size;
+    size_t capacity;
+    size_t nprocs;
+    Process* base;
+    heap_key key;
+} Heap;
+
+size_t* init_heap_positions(size_t nprocs);
+int init_heap(Heap* h, Process* base, size_t nprocs, heap_key key, size_t* position);
+int heap_push(Heap* h, Process* p);
+int heap_push_key(Heap* h, Process* p, int key);
+Process* heap_pop(Heap* h);
+Process* heap_peek(Heap* h);
+int heap_update(Heap* h, Process* p);
+bool heap_contains(Heap* h, Process* p);
+bool heap_before(Heap* h, Process* a, Process* b);
+size_t heap_size(Heap* h);
+void clean_heap(Heap* h);
+
+int remainingKey(Process *p);
+int priorityKey(Process *p);
+int wakeupKey(Process *p);
+int deadlineKey(Process *p);
+int rateKey(Process *p);
+
+#endif
@@ -0,0 +1,806 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <endian.h>
+#include "process.h"
+#include "loader.h"
+#include "stats.h"
+
+#define CSV_SEPARATOR ';'
+#define CSV_FIELDS 5         // obligatoris
+#define CSV_MAX_FIELDS 7     // més deadline i period, opcionals
+#define CSV_BURST_SEPARATOR ','
+#define CSV_MAX_BURSTS 1024
+#define READ_BLOCK (1 << 20)
+
+// Contingut del fitxer: projectat amb mmap si és un fitxer regular,
+// o llegit per blocs (pipes, /dev/stdin...) si no es pot projectar.
+typedef struct _filebuffer
+{
+    const char* data;
+    size_t size;
+    bool mapped;
+} FileBuffer;
+
+static int openFileBuffer(const char* filename, FileBuffer* fb)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+            fb->data = data;
+            fb->size = (size_t)st.st_size;
+            fb->mapped = true;
+            close(fd);
+            return EXIT_SUCCESS;
+        }
+    }
+
+    size_t size = 0;
+    size_t capacity = READ_BLOCK;
+    char* data = malloc(capacity);
+    ssize_t r;
+    while (data != NULL && (r = read(fd, data + size, capacity - size)) > 0)
+    {
+        size += (size_t)r;
+        if (size == capacity)
+        {
+            capacity *= 2;
+            char* grown = realloc(data, capacity);
+            if (grown == NULL)
+            {
+                free(data);
+            }
+            data = grown;
+        }
+    }
+    close(fd);
+    if (data == NULL)
+    {
+        fprintf(stderr, "%s: out of memory\n", filename);
+        return EXIT_FAILURE;
+    }
+    fb->data = data;
+    fb->size = size;
+    fb->mapped = false;
+    return EXIT_SUCCESS;
+}
+
+static void closeFileBuffer(FileBuffer* fb)
+{
+    if (fb->mapped)
+    {
+        munmap((void*)fb->data, fb->size);
+    }
+    else
+    {
+        free((void*)fb->data);
+    }
+}
+
+// Enter decimal amb signe opcional a [s, end). Retorna false si el camp és
+// buit, conté altres caràcters o no cap en un int.
+static bool parseInt(const char* s, const char* end, int* value)
+{
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        s++;
+    }
+    if (s == end)
+    {
+        return false;
+    }
+    long long v = 0;
+    for (; s < end; s++)
+    {
+        unsigned digit = (unsigned)(*s - '0');
+        if (digit > 9)
+        {
+            return false;
+        }
+        v = v * 10 + digit;
+        if (v > (long long)INT_MAX + 1)
+        {
+            return false;
+        }
+    }
+    v = negative ? -v : v;
+    if (v > INT_MAX || v < INT_MIN)
+    {
+        return false;
+    }
+    *value = (int)v;
+    return true;
+}
+
+static int growWorkload(Workload* w, size_t capacity)
+{
+    Process* procs = realloc(w->procs, capacity * sizeof(Process));
+    STATS_INC(STAT_MALLOCS);
+    if (procs == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    w->procs = procs;
+    w->capacity = capacity;
+    return EXIT_SUCCESS;
+}
+
+static size_t hashName(const char* s, size_t len)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+    }
+    return (size_t)h;
+}
+
+// Casella de la taula de dispersió on és (o aniria) el nom s
+static size_t findNameSlot(const Workload* w, const char* s, size_t len)
+{
+    size_t mask = w->name_slots_capacity - 1;
+    size_t slot = hashName(s, len) & mask;
+    while (w->name_slots[slot] != 0)
+    {
+        const char* name = w->names + w->name_slots[slot] - 1;
+        if (strncmp(name, s, len) == 0 && name[len] == '\0')
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Dobla la taula de dispersió (mantenint-la com a molt mig plena)
+static int growNameSlots(Workload* w)
+{
+    size_t capacity = w->name_slots_capacity > 0 ? 2 * w->name_slots_capacity : 1024;
+    size_t* old = w->name_slots;
+    size_t oldCapacity = w->name_slots_capacity;
+    w->name_slots = calloc(capacity, sizeof(size_t));
+    if (w->name_slots == NULL)
+    {
+        w->name_slots = old;
+        return EXIT_FAILURE;
+    }
+    w->name_slots_capacity = capacity;
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (old[i] != 0)
+        {
+            const char* name = w->names + old[i] - 1;
+            w->name_slots[findNameSlot(w, name, strlen(name))] = old[i];
+        }
+    }
+    free(old);
+    return EXIT_SUCCESS;
+}
+
+// Allibera la taula de dispersió quan la càrrega ha acabat
+static void dropNameSlots(Workload* w)
+{
+    free(w->name_slots);
+    w->name_slots = NULL;
+    w->name_slots_capacity = 0;
+    w->name_count = 0;
+}
+
+// Copia el nom al final del bloc de noms i en retorna el desplaçament.
+// Els punters definitius es calculen al final, quan el bloc ja no es mourà.
+static int appendName(Workload* w, const char* s, size_t len, size_t* offset)
+{
+    if (w->names_size + len + 1 > w->names_capacity)
+    {
+        size_t capacity = w->names_capacity > 0 ? w->names_capacity : 4096;
+        while (w->names_size + len + 1 > capacity)
+        {
+            capacity *= 2;
+        }
+        char* names = realloc(w->names, capacity);
+        STATS_INC(STAT_MALLOCS);
+        if (names == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        w->names = names;
+        w->names_capacity = capacity;
+    }
+    *offset = w->names_size;
+    memcpy(w->names + w->names_size, s, len);
+    w->names[w->names_size + len] = '\0';
+    w->names_size += len + 1;
+    return EXIT_SUCCESS;
+}
+
+// Com appendName(), però si el nom ja és al bloc en retorna el desplaçament
+// sense copiar-lo
+static int internName(Workload* w, const char* s, size_t len, size_t* offset)
+{
+    if (2 * (w->name_count + 1) > w->name_slots_capacity && growNameSlots(w) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+    size_t slot = findNameSlot(w, s, len);
+    if (w->name_slots[slot] != 0)
+    {
+        *offset = w->name_slots[slot] - 1;
+        return EXIT_SUCCESS;
+    }
+    if (appendName(w, s, len, offset) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+    w->name_slots[slot] = *offset + 1;
+    w->name_count++;
+    return EXIT_SUCCESS;
+}
+
+// Copia una seqüència de ràfegues al bloc de ràfegues i en retorna el
+// desplaçament, com appendName() amb els noms
+static int internBursts(Workload* w, const int* bursts, size_t n, size_t* offset)
+{
+    if (w->bursts_size + n > w->bursts_capacity)
+    {
+        size_t capacity = w->bursts_capacity > 0 ? w->bursts_capacity : 1024;
+        while (w->bursts_size + n > capacity)
+        {
+            capacity *= 2;
+        }
+        int* pool = realloc(w->bursts, capacity * sizeof(int));
+        STATS_INC(STAT_MALLOCS);
+        if (pool == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        w->bursts = pool;
+        w->bursts_capacity = capacity;
+    }
+    *offset = w->bursts_size;
+    memcpy(w->bursts + w->bursts_size, bursts, n * sizeof(int));
+    w->bursts_size += n;
+    return EXIT_SUCCESS;
+}
+
+// Assigna els punters definitius als noms i a les ràfegues, un cop els
+// blocs ja no es mouran
+static void fixupWorkload(Workload* w, const size_t* name_offsets, const size_t* burst_offsets)
+{
+    for (size_t p = 0; p < w->nprocs; p++)
+    {
+        w->procs[p].name = w->names + name_offsets[p];
+        if (w->procs[p].nbursts > 1)
+        {
+            w->procs[p].bursts = w->bursts + burst_offsets[p];
+        }
+    }
+}
+
+static const char* fieldNames[CSV_MAX_FIELDS] = {"id", "name", "priority", "arrive_time", "burst", "deadline", "period"};
+
+// Llegeix una línia "id;name;priority;arrive_time;burst[;deadline[;period]]"
+// a p. El camp burst pot ser una seqüència "cpu,io,cpu,..." de ràfegues
+// alternades. El termini és relatiu a l'arribada (o a cada alliberament,
+// si té període); buit o 0 vol dir que no en té. Retorna l'índex del camp
+// erroni, CSV_MAX_FIELDS si en sobren, o -1 si la línia és correcta.
+static int parseLine(Workload* w, const char* line, const char* end, Process* p, size_t* name_offset, size_t* burst_offset)
+{
+    const char* fields[CSV_MAX_FIELDS + 1];
+    const char* fieldEnds[CSV_MAX_FIELDS + 1];
+    int nfields = 0;
+    const char* s = line;
+    while (nfields <= CSV_MAX_FIELDS)
+    {
+        const char* sep = memchr(s, CSV_SEPARATOR, (size_t)(end - s));
+        fields[nfields] = s;
+        fieldEnds[nfields] = sep != NULL ? sep : end;
+        nfields++;
+        if (sep == NULL)
+        {
+            break;
+        }
+        s = sep + 1;
+    }
+    if (nfields < CSV_FIELDS)
+    {
+        return nfields;
+    }
+    // Un camp de més no es pot ajuntar a l'últim: la línia és mal formada
+    if (nfields > CSV_MAX_FIELDS)
+    {
+        return CSV_MAX_FIELDS;
+    }
+
+    int values[CSV_MAX_FIELDS] = {0};
+    for (int f = 0; f < CSV_MAX_FIELDS && f < nfields; f++)
+    {
+        bool optional = f >= CSV_FIELDS && fields[f] == fieldEnds[f];
+        if (f != 1 && f != 4 && !optional && !parseInt(fields[f], fieldEnds[f], &values[f]))
+        {
+            return f;
+        }
+    }
+    // Ràfegues: la primera a values[4] i la resta a bursts
+    int bursts[CSV_MAX_BURSTS];
+    int nbursts = 0;
+    s = fields[4];
+    while (true)
+    {
+        const char* comma = memchr(s, CSV_BURST_SEPARATOR, (size_t)(fieldEnds[4] - s));
+        const char* last = comma != NULL ? comma : fieldEnds[4];
+        if (nbursts == CSV_MAX_BURSTS || !parseInt(s, last, &bursts[nbursts]))
+        {
+            return 4;
+        }
+        nbursts++;
+        if (comma == NULL)
+        {
+            break;
+        }
+        s = comma + 1;
+    }
+    values[4] = bursts[0];
+    if (fieldEnds[1] == fields[1])
+    {
+        return 1;
+    }
+    if (values[3] < 0)
+    {
+        return 3;
+    }
+    if (values[4] <= 0)
+    {
+        return 4;
+    }
+    for (int f = CSV_FIELDS; f < CSV_MAX_FIELDS; f++)
+    {
+        if (values[f] < 0)
+        {
+            return f;
+        }
+    }
+    if (internName(w, fields[1], (size_t)(fieldEnds[1] - fields[1]), name_offset) != EXIT_SUCCESS)
+    {
+        return 1;
+    }
+    *p = initProcess(values[0], NULL, values[4], values[2], values[3]);
+    p->deadline = values[5];
+    p->period = values[6];
+    if (nbursts > 1 && (setBursts(p, bursts, nbursts) != EXIT_SUCCESS ||
+                        internBursts(w, bursts, (size_t)nbursts, burst_offset) != EXIT_SUCCESS))
+    {
+        return 4;
+    }
+    return -1;
+}
+
+// Carrega un fitxer CSV (id;name;priority;arrive_time;burst[;deadline[;period]]
+// per línia). sizeHint és el nombre de processos esperat; si és 0 s'estima
+// a partir de la mida del fitxer. Les línies buides s'ignoren i qualsevol línia
+// mal formada atura la càrrega indicant-ne el número.
+int loadCSVWorkload(const char* filename, size_t sizeHint, Workload* w)
+{
+    memset(w, 0, sizeof(Workload));
+
+    FileBuffer fb;
+    if (openFileBuffer(filename, &fb) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+
+    size_t capacity = sizeHint > 0 ? sizeHint : fb.size / 16 + 1;
+    size_t* name_offsets = malloc(capacity * sizeof(size_t));
+    size_t* burst_offsets = malloc(capacity * sizeof(size_t));
+    if (name_offsets == NULL || burst_offsets == NULL || growWorkload(w, capacity) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "%s: out of memory\n", filename);
+        free(name_offsets);
+        free(burst_offsets);
+        freeWorkload(w);
+        closeFileBuffer(&fb);
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    const char* s = fb.data;
+    const char* end = fb.data + fb.size;
+    size_t lineno = 0;
+    while (s < end)
+    {
+        lineno++;
+        const char* nl = memchr(s, '\n', (size_t)(end - s));
+        const char* eol = nl != NULL ? nl : end;
+        const char* next = nl != NULL ? nl + 1 : end;
+        if (eol > s && eol[-1] == '\r')
+        {
+            eol--;
+        }
+        if (eol == s)
+        {
+            s = next;
+            continue;
+        }
+
+        if (w->nprocs == w->capacity)
+        {
+            size_t* grown = realloc(name_offsets, 2 * w->capacity * sizeof(size_t));
+            if (grown != NULL)
+            {
+                name_offsets = grown;
+            }
+            size_t* grownBursts = grown != NULL ? realloc(burst_offsets, 2 * w->capacity * sizeof(size_t)) : NULL;
+            if (grownBursts != NULL)
+            {
+                burst_offsets = grownBursts;
+            }
+            if (grownBursts == NULL || growWorkload(w, 2 * w->capacity) != EXIT_SUCCESS)
+            {
+                fprintf(stderr, "%s: out of memory\n", filename);
+                status = EXIT_FAILURE;
+                break;
+            }
+        }
+
+        int bad = parseLine(w, s, eol, &w->procs[w->nprocs], &name_offsets[w->nprocs], &burst_offsets[w->nprocs]);
+        if (bad >= 0)
+        {
+            fprintf(stderr, "%s:%zu: invalid %s in \"%.*s\"\n", filename, lineno,
+                    bad < CSV_MAX_FIELDS ? fieldNames[bad] : "line", (int)(eol - s), s);
+            status = EXIT_FAILURE;
+            break;
+        }
+        w->nprocs++;
+        s = next;
+    }
+    closeFileBuffer(&fb);
+    dropNameSlots(w);
+
+    if (status == EXIT_SUCCESS)
+    {
+        fixupWorkload(w, name_offsets, burst_offsets);
+        STATS_ADD(STAT_LOAD_BYTES, end - fb.data);
+        STATS_ADD(STAT_LOAD_PROCS, w->nprocs);
+    }
+    else
+    {
+        freeWorkload(w);
+    }
+    free(name_offsets);
+    free(burst_offsets);
+    return status;
+}
+
+// Omple la taula amb els processos del generador, sense passar per cap
+// fitxer ni analitzar text. Els noms ("P<id>") van al bloc de noms com en
+// la càrrega CSV, sense internar-los perquè no es repeteixen. La taula
+// sencera queda en memòria, com amb els fitxers: és el que necessiten el
+// Gantt, la verificació i la conversió a binari. La resta de simulacions
+// consumeixen el generador en flux (init_generated_context()).
+int loadGeneratedWorkload(Generator* gen, Workload* w)
+{
+    memset(w, 0, sizeof(Workload));
+    size_t capacity = gen->nprocs > 0 ? gen->nprocs : 1;
+    size_t* name_offsets = malloc(capacity * sizeof(size_t));
+    size_t* burst_offsets = malloc(capacity * sizeof(size_t));
+    if (name_offsets == NULL || burst_offsets == NULL || growWorkload(w, capacity) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "generator: out of memory\n");
+        free(name_offsets);
+        free(burst_offsets);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+    resetGenerator(gen);
+    int bursts[2 * GENERATOR_MAX_CYCLES - 1];
+    int nbursts = 2 * gen->cycles - 1;
+    Process* p = w->procs;
+    while (nextProcess(gen, p, bursts))
+    {
+        char name[16];
+        int len = snprintf(name, sizeof(name), "P%d", p->id);
+        if (appendName(w, name, (size_t)len, &name_offsets[w->nprocs]) != EXIT_SUCCESS ||
+            (nbursts > 1 && (setBursts(p, bursts, nbursts) != EXIT_SUCCESS ||
+                             internBursts(w, bursts, (size_t)nbursts, &burst_offsets[w->nprocs]) != EXIT_SUCCESS)))
+        {
+            fprintf(stderr, "generator: out of memory\n");
+            free(name_offsets);
+            free(burst_offsets);
+            freeWorkload(w);
+            return EXIT_FAILURE;
+        }
+        w->nprocs++;
+        p++;
+    }
+    if (gen->overflow)
+    {
+        fprintf(stderr, "generator: arrivals plus total work exceed the simulation clock (%d) after %zu processes\n",
+                INT_MAX, w->nprocs);
+        free(name_offsets);
+        free(burst_offsets);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+    fixupWorkload(w, name_offsets, burst_offsets);
+    STATS_ADD(STAT_LOAD_PROCS, w->nprocs);
+    free(name_offsets);
+    free(burst_offsets);
+    return EXIT_SUCCESS;
+}
+
+// El format binari és little-endian: els camps es converteixen en llegir
+// i en escriure (en una màquina little-endian no fan res)
+static void recordFromLE(BinaryRecord* r)
+{
+    r->id = (int32_t)le32toh((uint32_t)r->id);
+    r->priority = (int32_t)le32toh((uint32_t)r->priority);
+    r->arrive_time = (int32_t)le32toh((uint32_t)r->arrive_time);
+    r->burst = (int32_t)le32toh((uint32_t)r->burst);
+    r->name = le32toh(r->name);
+    r->bursts = le32toh(r->bursts);
+    r->nbursts = le32toh(r->nbursts);
+    r->deadline = (int32_t)le32toh((uint32_t)r->deadline);
+    r->period = (int32_t)le32toh((uint32_t)r->period);
+}
+
+static void recordToLE(BinaryRecord* r)
+{
+    r->id = (int32_t)htole32((uint32_t)r->id);
+    r->priority = (int32_t)htole32((uint32_t)r->priority);
+    r->arrive_time = (int32_t)htole32((uint32_t)r->arrive_time);
+    r->burst = (int32_t)htole32((uint32_t)r->burst);
+    r->name = htole32(r->name);
+    r->bursts = htole32(r->bursts);
+    r->nbursts = htole32(r->nbursts);
+    r->deadline = (int32_t)htole32((uint32_t)r->deadline);
+    r->period = (int32_t)htole32((uint32_t)r->period);
+}
+
+// Carrega un fitxer binari escrit per saveBinaryWorkload(). El fitxer es
+// projecta en memòria i els noms s'hi referencien directament: només es
+// copien els camps numèrics a la taula de processos.
+int loadBinaryWorkload(const char* filename, Workload* w)
+{
+    memset(w, 0, sizeof(Workload));
+
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return EXIT_FAILURE;
+    }
+    size_t size = (size_t)st.st_size;
+    // La capçalera més curta és la de la versió 1; la mida de la de cada
+    // versió es comprova un cop llegida la versió
+    if (size < BINARY_V1_HEADER_SIZE)
+    {
+        fprintf(stderr, "%s: not a process table (too short)\n", filename);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    w->mapping = data;
+    w->mapping_size = size;
+
+    BinaryHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(&h, data, size < sizeof(h) ? size : sizeof(h));
+    const BinaryHeader* header = &h;
+    h.version = le32toh(h.version);
+    h.nprocs = le64toh(h.nprocs);
+    h.names_size = le64toh(h.names_size);
+    h.bursts_size = le64toh(h.bursts_size);
+    if (memcmp(header->magic, BINARY_MAGIC, sizeof(header->magic)) != 0)
+    {
+        fprintf(stderr, "%s: not a process table (bad magic)\n", filename);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+    if (header->version < 1 || header->version > BINARY_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported version %u (expected %u)\n", filename, header->version, BINARY_VERSION);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+    bool v1 = header->version == 1;
+    size_t header_size = v1 ? BINARY_V1_HEADER_SIZE : sizeof(BinaryHeader);
+    size_t record_size = v1 ? BINARY_V1_RECORD_SIZE : header->version == 2 ? BINARY_V2_RECORD_SIZE : sizeof(BinaryRecord);
+    uint64_t bursts_size = v1 ? 0 : header->bursts_size;
+    if (size < header_size)
+    {
+        fprintf(stderr, "%s: not a process table (too short)\n", filename);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+    uint64_t available = size >= header_size ? (size - header_size) / record_size : 0;
+    if (header->nprocs > available ||
+        bursts_size > (size - header_size - header->nprocs * record_size) / sizeof(int32_t) ||
+        header->names_size != size - header_size - header->nprocs * record_size - bursts_size * sizeof(int32_t) ||
+        (header->names_size > 0 && ((const char*)data)[size - 1] != '\0'))
+    {
+        fprintf(stderr, "%s: truncated or corrupt process table\n", filename);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+
+    size_t nprocs = (size_t)header->nprocs;
+    const char* records = (const char*)data + header_size;
+    const int* bursts = (const int*)(records + nprocs * record_size);
+    char* names = (char*)(bursts + bursts_size);
+    if (growWorkload(w, nprocs > 0 ? nprocs : 1) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "%s: out of memory\n", filename);
+        freeWorkload(w);
+        return EXIT_FAILURE;
+    }
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    // Les ràfegues no es poden fer servir des de la projecció: se'n fa una
+    // còpia en l'ordre de la màquina
+    if (bursts_size > 0)
+    {
+        w->bursts = malloc((size_t)bursts_size * sizeof(int));
+        if (w->bursts == NULL)
+        {
+            fprintf(stderr, "%s: out of memory\n", filename);
+            freeWorkload(w);
+            return EXIT_FAILURE;
+        }
+        for (size_t b = 0; b < bursts_size; b++)
+        {
+            uint32_t v;
+            memcpy(&v, bursts + b, sizeof(v));
+            w->bursts[b] = (int)le32toh(v);
+        }
+        w->bursts_size = w->bursts_capacity = (size_t)bursts_size;
+        bursts = w->bursts;
+    }
+#endif
+    for (size_t p = 0; p < nprocs; p++)
+    {
+        BinaryRecord r;
+        memset(&r, 0, sizeof(r));
+        memcpy(&r, records + p * record_size, record_size);
+        recordFromLE(&r);
+        bool valid = r.name < header->names_size && r.burst > 0 && r.arrive_time >= 0 && r.deadline >= 0 && r.period >= 0;
+        w->procs[p] = initProcess(r.id, names + r.name, r.burst, r.priority, r.arrive_time);
+        w->procs[p].deadline = r.deadline;
+        w->procs[p].period = r.period;
+        if (valid && r.nbursts > 1)
+        {
+            // Les ràfegues s'usen directament des de la projecció
+            valid = r.bursts <= bursts_size && r.nbursts <= bursts_size - r.bursts &&
+                    r.nbursts <= INT_MAX && setBursts(&w->procs[p], bursts + r.bursts, (int)r.nbursts) == EXIT_SUCCESS;
+        }
+        if (!valid)
+        {
+            fprintf(stderr, "%s: invalid record %zu\n", filename, p);
+            freeWorkload(w);
+            return EXIT_FAILURE;
+        }
+    }
+    w->nprocs = nprocs;
+    STATS_ADD(STAT_LOAD_BYTES, size);
+    STATS_ADD(STAT_LOAD_PROCS, nprocs);
+    return EXIT_SUCCESS;
+}
+
+int saveBinaryWorkload(const char* filename, const Workload* w)
+{
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    BinaryHeader header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.nprocs = w->nprocs;
+    header.names_size = 0;
+    header.bursts_size = 0;
+    for (size_t p = 0; p < w->nprocs; p++)
+    {
+        header.names_size += strlen(w->procs[p].name) + 1;
+        if (w->procs[p].nbursts > 1)
+        {
+            header.bursts_size += (uint64_t)w->procs[p].nbursts;
+        }
+    }
+    if (header.names_size > UINT32_MAX || header.bursts_size > UINT32_MAX)
+    {
+        fprintf(stderr, "%s: name or burst table too large\n", filename);
+        fclose(f);
+        return EXIT_FAILURE;
+    }
+
+    BinaryHeader le = header;
+    le.version = htole32(le.version);
+    le.nprocs = htole64(le.nprocs);
+    le.names_size = htole64(le.names_size);
+    le.bursts_size = htole64(le.bursts_size);
+    bool ok = fwrite(&le, sizeof(le), 1, f) == 1;
+    uint32_t offset = 0;
+    uint32_t burst_offset = 0;
+    for (size_t p = 0; ok && p < w->nprocs; p++)
+    {
+        Process* proc = &w->procs[p];
+        uint32_t nbursts = (uint32_t)proc->nbursts;
+        BinaryRecord r = {proc->id, proc->priority, proc->arrive_time, proc->burst, offset,
+                          nbursts > 1 ? burst_offset : 0, nbursts, proc->deadline, proc->period};
+        recordToLE(&r);
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+        offset += (uint32_t)strlen(proc->name) + 1;
+        burst_offset += nbursts > 1 ? nbursts : 0;
+    }
+    for (size_t p = 0; ok && p < w->nprocs; p++)
+    {
+        Process* proc = &w->procs[p];
+        if (proc->nbursts > 1)
+        {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            ok = fwrite(proc->bursts, sizeof(int32_t), (size_t)proc->nbursts, f) == (size_t)proc->nbursts;
+#else
+            for (int b = 0; ok && b < proc->nbursts; b++)
+            {
+                uint32_t v = htole32((uint32_t)proc->bursts[b]);
+                ok = fwrite(&v, sizeof(v), 1, f) == 1;
+            }
+#endif
+        }
+    }
+    for (size_t p = 0; ok && p < w->nprocs; p++)
+    {
+        const char* name = w->procs[p].name;
+        ok = fwrite(name, strlen(name) + 1, 1, f) == 1;
+    }
+    if (fclose(f) != 0 || !ok)
+    {
+        fprintf(stderr, "%s: write error\n", filename);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+void freeWorkload(Workload* w)
+{
+    free(w->procs);
+    free(w->names);
+    free(w->name_slots);
+    free(w->bursts);
+    if (w->mapping != NULL)
+    {
+        munmap(w->mapping, w->mapping_size);
+    }
+    memset(w, 0, sizeof(Workload));
+}
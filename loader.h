@@ -0,0 +1,79 @@
+#ifndef _LOADER_H_
+#define _LOADER_H_
+
+#include <stddef.h>
+#include "process.h"
+#include "generator.h"
+
+#include <stdint.h>
+
+// Taula de processos carregada d'un fitxer. Els noms dels processos
+// apunten a un únic bloc de memòria (names), propietat del Workload, o
+// directament a la taula de noms d'un fitxer binari projectat (mapping).
+// Durant la càrrega, els noms repetits s'internen: tots els processos amb
+// el mateix nom comparteixen una sola còpia.
+typedef struct _workload
+{
+    Process* procs;
+    size_t nprocs;
+    size_t capacity;
+    char* names;
+    size_t names_size;
+    size_t names_capacity;
+    size_t* name_slots;     // taula de dispersió de noms (desplaçament + 1); només durant la càrrega
+    size_t name_slots_capacity;
+    size_t name_count;
+    int* bursts;            // seqüències de ràfegues dels processos que en tenen més d'una
+    size_t bursts_size;
+    size_t bursts_capacity;
+    void* mapping;
+    size_t mapping_size;
+} Workload;
+
+// Format binari (little-endian en qualsevol màquina, versionat):
+//   BinaryHeader | BinaryRecord[nprocs] | ràfegues (int32[bursts_size]) |
+//   taula de noms (names_size bytes)
+// Cada nom és una cadena acabada en '\0' i el registre en guarda el
+// desplaçament dins la taula de noms. Els processos amb més d'una ràfega
+// en guarden la seqüència a la taula de ràfegues; la resta hi tenen nbursts 1
+// i la ràfega al camp burst. Les versions 1 (sense ràfegues) i 2 (sense
+// terminis) es continuen llegint. En una màquina big-endian els camps es
+// converteixen en llegir i escriure, i les ràfegues es copien en lloc de
+// fer-les servir des de la projecció.
+#define BINARY_MAGIC "SCHB"
+#define BINARY_VERSION 3
+
+typedef struct _binaryheader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t nprocs;
+    uint64_t names_size;
+    uint64_t bursts_size;   // només a partir de la versió 2
+} BinaryHeader;
+
+typedef struct _binaryrecord
+{
+    int32_t id;
+    int32_t priority;
+    int32_t arrive_time;
+    int32_t burst;          // temps total de CPU
+    uint32_t name;
+    uint32_t bursts;        // només a partir de la versió 2
+    uint32_t nbursts;
+    int32_t deadline;       // només a partir de la versió 3
+    int32_t period;
+} BinaryRecord;
+
+// Mides de la capçalera i dels registres de les versions anteriors
+#define BINARY_V1_HEADER_SIZE 24
+#define BINARY_V1_RECORD_SIZE 20
+#define BINARY_V2_RECORD_SIZE 28
+
+int loadCSVWorkload(const char* filename, size_t sizeHint, Workload* w);
+int loadBinaryWorkload(const char* filename, Workload* w);
+int loadGeneratedWorkload(Generator* gen, Workload* w);
+int saveBinaryWorkload(const char* filename, const Workload* w);
+void freeWorkload(Workload* w);
+
+#endif
@@ -3,113 +3,357 @@
 #include "string.h"
 #include "process.h"
 #include "scheduler.h"
+#include "loader.h"
+#include "sweep.h"
+#include "output.h"
+#include "stats.h"
 #include "stdbool.h"
 #include <getopt.h>
 
-#define OPTSTR "a:f:m:q:vh"
+#define OPTSTR "a:b:c:f:F:g:H:j:k:m:n:o:p:q:r:s:w:W:vVh"
+#define ALL "all"
+#define OPT_AGING 256
+#define OPT_STATS 257
+#define OPT_WINDOW 258
 
+// Opcions sense lletra
+static const struct option longOptions[] = {
+    {"aging", required_argument, NULL, OPT_AGING},
+    {"stats", no_argument, NULL, OPT_STATS},
+    {"window", required_argument, NULL, OPT_WINDOW},
+    {NULL, 0, NULL, 0},
+};
 
 
-void clean(void);
-void usage(void);
 
-char *filename = NULL;
-char *algorithm = NULL;
-char *modality = NULL;
-int quantum = 0;
-bool verbose = false;
+// Opcions de la línia d'ordres
+typedef struct _arguments
+{
+    char *filename;
+    char *binaryFilename;
+    char *outputFilename;
+    char *generatorSpec;
+    char *algorithm;
+    char *modality;
+    int quantum;
+    int quantumMax;
+    int objective;
+    int threads;
+    size_t sizeHint;
+    CPUConfig cpuConfig;
+    int format;
+    int width;
+    int backend;
+    bool verbose;
+    bool verify;
+    uint64_t seed;
+    int horizon;
+    int aging;
+    bool stats;
+    size_t window;
+} Arguments;
+
+void clean(Arguments *args);
+void usage(void);
+int loadWorkload(const Arguments *args, Workload *workload);
+int verifyAll(const Arguments *args, Process *procTable, size_t nprocs);
+void printStats(const Arguments *args, size_t nprocs);
 
 int main(int argc, char *argv[]){
 
+    Arguments args = {NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, OBJ_WAITING, 0, 0, {1, PLACE_LEAST, BALANCE_STEAL}, FORMAT_GANTT, 0, BACKEND_HEAP, false, false, 1, 0, 0, false, 0};
+
     int opt;
-    while ((opt = getopt(argc, argv, OPTSTR)) != EOF)
+    while ((opt = getopt_long(argc, argv, OPTSTR, longOptions, NULL)) != EOF)
         switch(opt) {
             case 'h': usage(); 
-                clean(); 
+                clean(&args); 
                 return EXIT_SUCCESS;
                 break;  
             case 'v':
-                verbose = true;
+                args.verbose = true;
+                break;
+            case 'V':
+                args.verify = true;
                 break;
             case 'q':
-                quantum = atoi(optarg);
+                // Un valor o un rang "min..max" per al mode comparatiu
+                args.quantum = atoi(optarg);
+                args.quantumMax = strstr(optarg, "..") != NULL ? atoi(strstr(optarg, "..") + 2) : args.quantum;
+                if (args.quantumMax < args.quantum){
+                    fprintf(stderr, "Invalid quantum range: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                    args.objective = -1;
+                    for (int i = 0; i < num_objectives(); i++) {
+                        if (strcmp(optarg, objectivesNames[i]) == 0) {
+                            args.objective = i;
+                            break;
+                        }
+                    }
+                    if (args.objective < 0){
+                        fprintf(stderr, "No such objective: %s\n", optarg);
+                        clean(&args);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+            case 'j':
+                args.threads = atoi(optarg);
+                break;
+            case 'r':
+                args.seed = strtoull(optarg, NULL, 10);
+                break;
+            case OPT_STATS:
+                args.stats = true;
+                break;
+            case OPT_AGING:
+                args.aging = atoi(optarg);
+                if (args.aging <= 0){
+                    fprintf(stderr, "Invalid aging: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_WINDOW:
+                args.window = strtoul(optarg, NULL, 10);
+                if (args.window == 0){
+                    fprintf(stderr, "Invalid window: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'H':
+                args.horizon = atoi(optarg);
+                if (args.horizon <= 0){
+                    fprintf(stderr, "Invalid horizon: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'n':
+                args.sizeHint = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                args.cpuConfig.ncpus = atoi(optarg);
+                if (args.cpuConfig.ncpus <= 0){
+                    fprintf(stderr, "Invalid number of CPUs: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'p':
+                    args.cpuConfig.placement = -1;
+                    for (int i = 0; i < num_placements(); i++) {
+                        if (strcmp(optarg, placementsNames[i]) == 0) {
+                            args.cpuConfig.placement = i;
+                            break;
+                        }
+                    }
+                    if (args.cpuConfig.placement < 0){
+                        fprintf(stderr, "No such placement: %s\n", optarg);
+                        clean(&args);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+            case 'o':
+                    args.format = -1;
+                    for (int i = 0; i < num_formats(); i++) {
+                        if (strcmp(optarg, formatsNames[i]) == 0) {
+                            args.format = i;
+                            break;
+                        }
+                    }
+                    if (args.format < 0){
+                        fprintf(stderr, "No such output format: %s\n", optarg);
+                        clean(&args);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+            case 'k':
+                    args.backend = -1;
+                    for (int i = 0; i < num_backends(); i++) {
+                        if (strcmp(optarg, backendsNames[i]) == 0) {
+                            args.backend = i;
+                            break;
+                        }
+                    }
+                    if (args.backend < 0){
+                        fprintf(stderr, "No such backend: %s\n", optarg);
+                        clean(&args);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+            case 'W':
+                args.width = atoi(optarg);
+                if (args.width <= 0){
+                    fprintf(stderr, "Invalid width: %s\n", optarg);
+                    clean(&args);
+                    return EXIT_FAILURE;
+                }
                 break;
+            case 'b':
+                    args.cpuConfig.balancing = -1;
+                    for (int i = 0; i < num_balancings(); i++) {
+                        if (strcmp(optarg, balancingsNames[i]) == 0) {
+                            args.cpuConfig.balancing = i;
+                            break;
+                        }
+                    }
+                    if (args.cpuConfig.balancing < 0){
+                        fprintf(stderr, "No such balancing: %s\n", optarg);
+                        clean(&args);
+                        return EXIT_FAILURE;
+                    }
+                    break;
             case 'f': 
-                    filename = strdup(optarg); 
+                    args.filename = strdup(optarg); 
+                break;
+            case 'F':
+                    args.binaryFilename = strdup(optarg);
+                break;
+            case 'g':
+                    args.generatorSpec = strdup(optarg);
+                break;
+            case 'w':
+                    args.outputFilename = strdup(optarg);
                 break;
             case 'a':
-                    for (int i = 0; i < num_algorithms(); i++) {
-                        if (strcmp(optarg, algorithmsNames[i]) == 0) {
-                            algorithm = strdup(optarg); 
+                    if (strcmp(optarg, ALL) == 0) {
+                        args.algorithm = strdup(optarg);
+                    }
+                    for (int i = 0; args.algorithm == NULL && i < num_algorithms(); i++) {
+                        if (strcmp(optarg, algorithm_name(i)) == 0) {
+                            args.algorithm = strdup(optarg); 
                             break;
                         }
                     }
-                     if (algorithm == NULL){
+                     if (args.algorithm == NULL){
                         fprintf(stderr, "No such algorithm: %s\n", optarg);
-                        clean();
+                        clean(&args);
                         return EXIT_FAILURE;
                     }
                     break;
             case 'm':
-                    for (int i = 0; i < num_modalities(); i++) {
+                    if (strcmp(optarg, ALL) == 0) {
+                        args.modality = strdup(optarg);
+                    }
+                    for (int i = 0; args.modality == NULL && i < num_modalities(); i++) {
                         if (strcmp(optarg, modalitiesNames[i]) == 0) {
-                            modality = strdup(optarg);
+                            args.modality = strdup(optarg);
                             break;
                         }
                     }
-                    if (modality == NULL){
+                    if (args.modality == NULL){
                         fprintf(stderr, "No such modality: %s\n", optarg);
-                        clean();
+                        clean(&args);
                         return EXIT_FAILURE;
                     }
                     break;
     }
 
-    if ( algorithm != NULL && filename != NULL && modality != NULL){
+    // Mode conversió: llegeix la taula i l'escriu en format binari
+    if (args.outputFilename != NULL && (args.filename != NULL || args.binaryFilename != NULL || args.generatorSpec != NULL)){
+        Workload workload;
+        int status = loadWorkload(&args, &workload);
+        size_t nprocs = 0;
+        if (status == EXIT_SUCCESS){
+            nprocs = workload.nprocs;
+            status = saveBinaryWorkload(args.outputFilename, &workload);
+            freeWorkload(&workload);
+        }
+        printStats(&args, nprocs);
+        clean(&args);
+        return status;
+    }
 
-        Process * procTable;
-        size_t nprocs = initFromCSVFile(filename, &procTable);
+    int status = EXIT_SUCCESS;
+    if ( args.algorithm != NULL && (args.filename != NULL || args.binaryFilename != NULL || args.generatorSpec != NULL) && args.modality != NULL){
 
-        
-        if (strncmp(algorithm, algorithmsNames[FCFS], sizeof(algorithmsNames[FCFS])/sizeof(char *))==0){
-            if (strncmp(modality, modalitiesNames[PREEMPTIVE], sizeof(modalitiesNames[PREEMPTIVE])/sizeof(char *) ) == 0){
-                printf("%s can not be executed in %s mode ... changing to %s\n",algorithmsNames[FCFS],
-                 modalitiesNames[PREEMPTIVE], modalitiesNames[NONPREEMPTIVE]);
-            }
-            run_dispatcher(procTable,nprocs,FCFS,NONPREEMPTIVE,quantum);
-        }else if (strcmp(algorithm, algorithmsNames[SJF])==0){
-            if (strcmp(modality, modalitiesNames[PREEMPTIVE])==0){
-                run_dispatcher(procTable,nprocs,SJF,PREEMPTIVE,quantum);
-            }else{
-                run_dispatcher(procTable,nprocs,SJF,NONPREEMPTIVE,quantum);
-            }
-            
-        }else if (strcmp(algorithm, algorithmsNames[PRIORITIES])==0){
-            if (strcmp(modality, modalitiesNames[PREEMPTIVE])==0){
-                run_dispatcher(procTable,nprocs,PRIORITIES,PREEMPTIVE,quantum);
-            }else{
-                run_dispatcher(procTable,nprocs,PRIORITIES,NONPREEMPTIVE,quantum);
-            }     
-        } else if (strcmp(algorithm, algorithmsNames[RR])==0){
-            if(quantum<=0){
-                printf("%s can not be executed without a quantum setting to Q=1\n",algorithmsNames[RR]);
-                quantum=1;
-            }else{
-            if (strncmp(modality, modalitiesNames[NONPREEMPTIVE], sizeof(modalitiesNames[NONPREEMPTIVE])/sizeof(char *) ) == 0){
-                printf("%s can not be executed in %s mode ... changing to %s\n",algorithmsNames[RR],
-                 modalitiesNames[NONPREEMPTIVE], modalitiesNames[PREEMPTIVE]);
-            }
-            }
-            run_dispatcher(procTable,nprocs,RR,PREEMPTIVE,quantum);
-        }       
-        
-        free(procTable);
+        bool sweeping = strcmp(args.algorithm, ALL) == 0 || strcmp(args.modality, ALL) == 0 || args.quantumMax != args.quantum;
+        // Mode flux: els processos generats s'admeten a mesura que arriben i
+        // s'alliberen en acabar, sense taula. La verificació i el Gantt
+        // necessiten la taula sencera.
+        Generator generator;
+        bool streaming = args.generatorSpec != NULL && !args.verify && (sweeping || args.format != FORMAT_GANTT);
+        if (streaming && parseGenerator(args.generatorSpec, &generator) != EXIT_SUCCESS){
+            printStats(&args, 0);
+            clean(&args);
+            return EXIT_FAILURE;
+        }
+
+        Workload workload = {0};
+        if (!streaming && loadWorkload(&args, &workload) != EXIT_SUCCESS){
+            printStats(&args, 0);
+            clean(&args);
+            return EXIT_FAILURE;
+        }
+        Process * procTable = workload.procs;
+        size_t nprocs = streaming ? generator.nprocs : workload.nprocs;
+        SimOptions options = {FCFS, NONPREEMPTIVE, args.quantum, args.cpuConfig, false, args.verbose, args.format, args.width, args.backend,
+                              false, args.seed, args.horizon, args.aging};
+
+        // Mode verificació: bucles especialitzats contra el genèric
+        if (args.verify){
+            status = verifyAll(&args, procTable, nprocs);
+            printStats(&args, nprocs);
+            freeWorkload(&workload);
+            clean(&args);
+            return status;
+        }
+
+        // Mode comparatiu: totes les combinacions demanades en paral·lel
+        if (sweeping){
+            Sweep sweep = {SWEEP_ALL, SWEEP_ALL, args.quantum > 0 ? args.quantum : 1, args.quantumMax > 0 ? args.quantumMax : 1,
+                           args.cpuConfig, args.objective, args.threads, args.backend, args.seed, args.horizon, args.aging,
+                           streaming ? &generator : NULL, args.window};
+            if (strcmp(args.algorithm, ALL) != 0)
+                sweep.algorithm = find_policy(args.algorithm);
+            for (int i = 0; i < num_modalities(); i++)
+                if (strcmp(args.modality, modalitiesNames[i]) == 0) sweep.modality = i;
+            status = run_sweep(procTable, nprocs, &sweep);
+            printStats(&args, nprocs);
+            freeWorkload(&workload);
+            clean(&args);
+            return status;
+        }
+
+        // Les restriccions de cada algorisme (modalitats admeses, quantum)
+        // venen de la seva política
+        options.algorithm = find_policy(args.algorithm);
+        const Policy *policy = get_policy(options.algorithm);
+        int modality = strcmp(args.modality, modalitiesNames[PREEMPTIVE]) == 0 ? PREEMPTIVE : NONPREEMPTIVE;
+        options.modality = policy_modality(policy, modality);
+        if (policy->quantum && args.quantum <= 0){
+            printf("%s can not be executed without a quantum setting to Q=1\n", policy->name);
+            args.quantum = 1;
+        }else if (options.modality != modality){
+            printf("%s can not be executed in %s mode ... changing to %s\n", policy->name,
+                   modalitiesNames[modality], modalitiesNames[options.modality]);
+        }
+        options.quantum = args.quantum;
+        SimContext ctx;
+        if ((streaming ? init_generated_context(&ctx, &generator, args.window, &options)
+                       : init_context(&ctx, procTable, nprocs, &options)) != EXIT_SUCCESS){
+            fprintf(stderr, "Out of memory\n");
+            printStats(&args, nprocs);
+            freeWorkload(&workload);
+            clean(&args);
+            return EXIT_FAILURE;
+        }
+        if (run_dispatcher(&ctx) != EXIT_SUCCESS)
+            status = EXIT_FAILURE;
+        clean_context(&ctx);
+        printStats(&args, nprocs);
+        freeWorkload(&workload);
     } else {
         fprintf(stderr, "algorithm:filename:modality are required to run simulation.\n");
     }
 
-    clean();
-    return EXIT_SUCCESS;
+    clean(&args);
+    return status;
 }
    
     
@@ -117,24 +361,130 @@ int main(int argc, char *argv[]){
 void usage(){
       fprintf(stderr,
       " usage:\n"
-      "    ./schsim  [-a [fcfs,sjf,rr,priorities]] [-h] [-m] [-f inputFile]\n"
-      "       -a  [fcfs,sjf,rr,priorities]  \n"
-      "       -m    [preemptive,nonpreemptive]  \n"
+      "    ./schsim  [-a [fcfs,sjf,rr,priorities,mlfq,cfs,lottery,stride,edf,rm]] [-h] [-m] [-f inputFile]\n"
+      "       -a  [fcfs,sjf,rr,priorities,mlfq,cfs,lottery,stride,edf,rm,all]  \n"
+      "           mlfq: multilevel feedback queue, quantum q << level, demoted when it\n"
+      "                 uses up its level's quantum (needs -q)\n"
+      "           cfs: runs the process with the least virtual runtime (weighted by priority)\n"
+      "           lottery, stride: proportional share, priority as tickets (need -q)\n"
+      "           edf: earliest absolute deadline first; rm: rate monotonic (shortest period)\n"
+      "       -m    [preemptive,nonpreemptive,all]  \n"
       "       -h:            print out this help message\n"
       "       -f file.csv:  read process table from csv file\n"
-      "       -v activate verbose \n"
+      "       -F file.bin:  read process table from binary file\n"
+      "       -g spec:      generate the processes instead of reading them, e.g.\n"
+      "                     poisson:lambda=0.1,burst=exp:mean=10,prio=uniform:0..9,n=1000,seed=1\n"
+      "                     arrivals: poisson:lambda, bursty:lambda,size\n"
+      "                     bursts: exp:mean, lognormal:mu,sigma, pareto:alpha,xm, uniform:min..max\n"
+      "                     io=dist,cycles=k: k CPU bursts per process separated by I/O\n"
+      "                     with -o csv/json or in comparison mode the processes are streamed:\n"
+      "                     only the live ones are kept and each one is written when it finishes\n"
+      "       --window n:   streamed processes alive at once (default 65536)\n"
+      "       -w file.bin:  write the process table (-f/-F/-g) as binary and exit\n"
+      "       -n nprocs:    expected number of processes (preallocation hint)\n"
+      "       -c ncpus:     number of simulated processors (default 1)\n"
+      "       -p [rr,least]:  placement of arriving processes on CPU queues\n"
+      "       -b [none,steal]:  load balancing between CPU queues\n"
+      "       -r seed:      seed of the lottery draws (default 1)\n"
+      "       -H horizon:   periodic tasks release jobs before this instant (default: hyperperiod)\n"
+      "       --aging n:    priorities: a waiting process gains one level every n time units\n"
+      "       --stats:      print the simulator's internal counters and timers on stderr\n"
+      "       -k [heap,scalar,simd]:  ready queue of sjf/priorities/edf/rm: indexed heap or a scan\n"
+      "                     of a key array (simd: avx2/sse2 when the machine has them)\n"
+      "    comparison mode (-a all, -m all or -q min..max):\n"
+      "       -s [waiting,response,return,returnN,duration,p99waiting,p99response,maxwait]:  sort the table by this metric\n"
+      "       -j threads:   worker threads (default: one per core)\n"
+      "       -o [gantt,csv,json]:  output format (default gantt)\n"
+      "       -W columns:   width of the gantt chart; longer runs are downsampled\n"
+      "       -v activate verbose (metrics per priority class, also in json)\n"
+      "       -V:           check that the specialized loops schedule exactly like the generic one\n"
+      "                     for every selected configuration (accepts -a all, -m all, -q min..max);\n"
+      "                     configurations without a specialized loop are reported as skipped\n"
       "\n");
 }
 
 
 
-void clean(){
-    if (algorithm != NULL)
-        free(algorithm);
+int loadWorkload(const Arguments *args, Workload *workload){
+    STATS_TIMER_START(start);
+    int status;
+    if (args->generatorSpec != NULL){
+        Generator gen;
+        status = parseGenerator(args->generatorSpec, &gen);
+        if (status == EXIT_SUCCESS)
+            status = loadGeneratedWorkload(&gen, workload);
+    } else if (args->binaryFilename != NULL){
+        status = loadBinaryWorkload(args->binaryFilename, workload);
+    } else {
+        status = loadCSVWorkload(args->filename, args->sizeHint, workload);
+    }
+    STATS_TIMER_STOP(TIMER_LOAD, start);
+    return status;
+}
+
+// Comprova cada configuració seleccionada (amb all i el rang de quantum
+// com al mode comparatiu) i n'escriu el resultat. Les que no tenen bucle
+// especialitzat es donen per omeses, no per idèntiques.
+int verifyAll(const Arguments *args, Process *procTable, size_t nprocs){
+    int status = EXIT_SUCCESS;
+    for (int a = 0; a < num_algorithms(); a++){
+        const Policy *policy = get_policy(a);
+        if (strcmp(args->algorithm, ALL) != 0 && strcmp(args->algorithm, policy->name) != 0)
+            continue;
+        for (int m = 0; m < num_modalities(); m++){
+            if (strcmp(args->modality, ALL) != 0 && strcmp(args->modality, modalitiesNames[m]) != 0)
+                continue;
+            // Només les modalitats que admet la política (FCFS no és preemptiu...)
+            if (!policy_accepts(policy, m))
+                continue;
+            int qmin = policy->quantum ? (args->quantum > 0 ? args->quantum : 1) : 0;
+            int qmax = policy->quantum ? (args->quantumMax > qmin ? args->quantumMax : qmin) : 0;
+            for (int q = qmin; q <= qmax; q++){
+                SimOptions options = {a, m, q, args->cpuConfig, true, false, FORMAT_GANTT, 0, args->backend, false, args->seed, args->horizon, args->aging};
+                // Sense bucle especialitzat es compararia el genèric amb ell mateix
+                if (!has_specialized(&options)){
+                    printf("%s %s q=%d: skipped (no specialized loop)\n", policy->name, modalitiesNames[m], q);
+                    continue;
+                }
+                bool ok = verify_specialized(procTable, nprocs, &options) == EXIT_SUCCESS;
+                printf("%s %s q=%d: %s\n", policy->name, modalitiesNames[m], q, ok ? "identical" : "DIFFERENT");
+                if (!ok)
+                    status = EXIT_FAILURE;
+            }
+        }
+    }
+    return status;
+}
+
+// Amb --stats, escriu els comptadors a stderr, fora de la sortida CSV/JSON.
+// Es crida a tots els camins que han carregat (o intentat carregar) una
+// taula; al mode comparatiu inclouen els de tots els fils.
+void printStats(const Arguments *args, size_t nprocs){
+    if (!args->stats)
+        return;
+    OutBuf ob;
+    if (init_outbuf(&ob, stderr) == EXIT_SUCCESS){
+        writeStats(&ob, &simStats, nprocs);
+        clean_outbuf(&ob);
+    }
+}
+
+void clean(Arguments *args){
+    if (args->algorithm != NULL)
+        free(args->algorithm);
+
+    if (args->filename != NULL)
+        free(args->filename);
+
+    if (args->binaryFilename != NULL)
+        free(args->binaryFilename);
+
+    if (args->outputFilename != NULL)
+        free(args->outputFilename);
 
-    if (filename != NULL)
-        free(filename);
+    if (args->generatorSpec != NULL)
+        free(args->generatorSpec);
 
-    if (modality != NULL)
-        free(modality);
+    if (args->modality != NULL)
+        free(args->modality);
 }
\ No newline at end of file
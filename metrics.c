@@ -0,0 +1,491 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "metrics.h"
+
+static size_t bucketOf(double value)
+{
+    if (!(value >= 1))
+    {
+        return 0;
+    }
+    int e;
+    double f = frexp(value, &e); // value = f * 2^e, f a [0.5, 1)
+    if (e > 64)
+    {
+        return STAT_BUCKETS - 1;
+    }
+    size_t sub = (size_t)((f - 0.5) * 2 * STAT_SUBBUCKETS);
+    return 1 + (size_t)(e - 1) * STAT_SUBBUCKETS + sub;
+}
+
+// Valor representatiu d'un interval: el límit inferior mentre els
+// intervals tenen amplada <= 1 (els enters petits són exactes) i el punt
+// mitjà a partir d'aquí
+static double bucketValue(size_t b)
+{
+    if (b == 0)
+    {
+        return 0;
+    }
+    int e = (int)((b - 1) / STAT_SUBBUCKETS) + 1;
+    size_t sub = (b - 1) % STAT_SUBBUCKETS;
+    double low = ldexp(0.5 + (double)sub / (2.0 * STAT_SUBBUCKETS), e);
+    double width = ldexp(1.0 / (2.0 * STAT_SUBBUCKETS), e);
+    return width <= 1 ? low : low + width / 2;
+}
+
+static void init_stat(Stat *s)
+{
+    memset(s, 0, sizeof(Stat));
+}
+
+static void clean_stat(Stat *s)
+{
+    free(s->buckets);
+    init_stat(s);
+}
+
+// Amplia la finestra de l'histograma perquè inclogui l'interval b, per
+// octaves senceres (com a molt STAT_BUCKETS intervals)
+static int stat_reserve(Stat *s, size_t b)
+{
+    if (s->count > 0 && b >= s->first && b < s->first + s->count)
+    {
+        return EXIT_SUCCESS;
+    }
+    size_t lo = s->count > 0 && s->first < b ? s->first : b;
+    size_t last = s->count > 0 && s->first + s->count - 1 > b ? s->first + s->count - 1 : b;
+    lo = lo == 0 ? 0 : 1 + (lo - 1) / STAT_SUBBUCKETS * STAT_SUBBUCKETS;
+    size_t hi = last == 0 ? 1 : 1 + ((last - 1) / STAT_SUBBUCKETS + 1) * STAT_SUBBUCKETS;
+    size_t *buckets = calloc(hi - lo, sizeof(size_t));
+    if (buckets == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    if (s->count > 0)
+    {
+        memcpy(buckets + (s->first - lo), s->buckets, s->count * sizeof(size_t));
+    }
+    free(s->buckets);
+    s->buckets = buckets;
+    s->first = lo;
+    s->count = hi - lo;
+    return EXIT_SUCCESS;
+}
+
+// Afegeix un valor. Sense memòria per ampliar l'histograma, l'estadístic
+// no canvia i retorna EXIT_FAILURE.
+int stat_add(Stat *s, double value)
+{
+    size_t b = bucketOf(value);
+    if (stat_reserve(s, b) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+    s->n++;
+    double delta = value - s->mean;
+    s->mean += delta / (double)s->n;
+    s->m2 += delta * (value - s->mean);
+    if (s->n == 1 || value < s->min)
+    {
+        s->min = value;
+    }
+    if (s->n == 1 || value > s->max)
+    {
+        s->max = value;
+    }
+    s->buckets[b - s->first]++;
+    return EXIT_SUCCESS;
+}
+
+double stat_stddev(const Stat *s)
+{
+    return s->n > 1 ? sqrt(s->m2 / (double)(s->n - 1)) : 0;
+}
+
+// Valor en la posició rank (1..n) segons l'histograma
+static double stat_at(const Stat *s, size_t rank)
+{
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank >= s->n)
+    {
+        return s->max;
+    }
+    size_t seen = 0;
+    size_t b = 0;
+    while (b < s->count - 1 && seen + s->buckets[b] < rank)
+    {
+        seen += s->buckets[b];
+        b++;
+    }
+    double value = bucketValue(s->first + b);
+    return value < s->min ? s->min : value > s->max ? s->max : value;
+}
+
+static size_t rankOf(size_t n, double p)
+{
+    return (size_t)ceil(p / 100.0 * (double)n);
+}
+
+// Percentil p (0-100) a partir de l'histograma
+double stat_percentile(const Stat *s, double p)
+{
+    return s->n > 0 ? stat_at(s, rankOf(s->n, p)) : 0;
+}
+
+void stat_summary(const Stat *s, StatSummary *summary)
+{
+    summary->n = s->n;
+    summary->mean = s->mean;
+    summary->stddev = stat_stddev(s);
+    summary->min = s->min;
+    for (size_t p = 0; p < NUM_PERCENTILES; p++)
+    {
+        summary->percentiles[p] = stat_percentile(s, metricsPercentiles[p]);
+    }
+    summary->max = s->max;
+}
+
+int signedstat_add(SignedStat *s, double value)
+{
+    if (stat_add(&s->all, value) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+    return stat_add(value < 0 ? &s->below : &s->above, value < 0 ? -value : value);
+}
+
+// Els negatius van primer, del més petit (el més gran canviat de signe)
+// al més proper a 0
+double signedstat_percentile(const SignedStat *s, double p)
+{
+    if (s->all.n == 0)
+    {
+        return 0;
+    }
+    size_t rank = rankOf(s->all.n, p);
+    rank = rank < 1 ? 1 : rank;
+    if (rank <= s->below.n)
+    {
+        return -stat_at(&s->below, s->below.n - rank + 1);
+    }
+    return stat_at(&s->above, rank - s->below.n);
+}
+
+void signedstat_summary(const SignedStat *s, StatSummary *summary)
+{
+    stat_summary(&s->all, summary);
+    for (size_t p = 0; p < NUM_PERCENTILES; p++)
+    {
+        summary->percentiles[p] = signedstat_percentile(s, metricsPercentiles[p]);
+    }
+}
+
+void init_metrics(Metrics *m, bool byClass)
+{
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        init_stat(&m->all[i]);
+    }
+    m->byClass = byClass;
+    m->classes = NULL;
+    m->nclasses = 0;
+    m->capacity = 0;
+    m->index = NULL;
+    m->indexSize = 0;
+    m->end = 0;
+    init_stat(&m->share);
+    m->received = 0;
+    m->entitled = 0;
+    init_stat(&m->lateness.all);
+    init_stat(&m->lateness.below);
+    init_stat(&m->lateness.above);
+    init_stat(&m->tardiness);
+    m->misses = 0;
+}
+
+void clean_metrics(Metrics *m)
+{
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        clean_stat(&m->all[i]);
+    }
+    for (size_t c = 0; c < m->nclasses; c++)
+    {
+        for (int i = 0; i < NUM_METRICS; i++)
+        {
+            clean_stat(&m->classes[c].stat[i]);
+        }
+    }
+    free(m->classes);
+    free(m->index);
+    clean_stat(&m->share);
+    clean_stat(&m->lateness.all);
+    clean_stat(&m->lateness.below);
+    clean_stat(&m->lateness.above);
+    clean_stat(&m->tardiness);
+    init_metrics(m, m->byClass);
+}
+
+static size_t hashPriority(int priority, size_t size)
+{
+    return (size_t)((uint32_t)priority * 2654435761u) & (size - 1);
+}
+
+// Refà la taula de dispersió amb size posicions (potència de 2)
+static int indexClasses(Metrics *m, size_t size)
+{
+    size_t *index = calloc(size, sizeof(size_t));
+    if (index == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    for (size_t c = 0; c < m->nclasses; c++)
+    {
+        size_t h = hashPriority(m->classes[c].priority, size);
+        while (index[h] != 0)
+        {
+            h = (h + 1) & (size - 1);
+        }
+        index[h] = c + 1;
+    }
+    free(m->index);
+    m->index = index;
+    m->indexSize = size;
+    return EXIT_SUCCESS;
+}
+
+// Classe d'una prioritat; es crea al final de classes si no existeix.
+// NULL si no hi ha memòria.
+static MetricClass *findClass(Metrics *m, int priority)
+{
+    size_t h = 0;
+    if (m->indexSize > 0)
+    {
+        h = hashPriority(priority, m->indexSize);
+        while (m->index[h] != 0)
+        {
+            MetricClass *c = &m->classes[m->index[h] - 1];
+            if (c->priority == priority)
+            {
+                return c;
+            }
+            h = (h + 1) & (m->indexSize - 1);
+        }
+    }
+    if (m->nclasses == m->capacity)
+    {
+        size_t capacity = m->capacity > 0 ? 2 * m->capacity : 8;
+        MetricClass *classes = realloc(m->classes, capacity * sizeof(MetricClass));
+        if (classes == NULL)
+        {
+            return NULL;
+        }
+        m->classes = classes;
+        m->capacity = capacity;
+    }
+    if (2 * (m->nclasses + 1) > m->indexSize)
+    {
+        if (indexClasses(m, m->indexSize > 0 ? 2 * m->indexSize : 16) != EXIT_SUCCESS)
+        {
+            return NULL;
+        }
+        h = hashPriority(priority, m->indexSize);
+        while (m->index[h] != 0)
+        {
+            h = (h + 1) & (m->indexSize - 1);
+        }
+    }
+    MetricClass *c = &m->classes[m->nclasses];
+    c->priority = priority;
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        init_stat(&c->stat[i]);
+    }
+    c->received = 0;
+    c->entitled = 0;
+    m->index[h] = ++m->nclasses;
+    return c;
+}
+
+static int compareClasses(const void *a, const void *b)
+{
+    int pa = ((const MetricClass *)a)->priority;
+    int pb = ((const MetricClass *)b)->priority;
+    return (pa > pb) - (pa < pb);
+}
+
+// Ordena les classes per prioritat per mostrar-les. Es crida en acabar la
+// simulació; la taula de dispersió es refà amb les noves posicions.
+void sort_metrics(Metrics *m)
+{
+    if (m->nclasses == 0)
+    {
+        return;
+    }
+    qsort(m->classes, m->nclasses, sizeof(MetricClass), compareClasses);
+    if (indexClasses(m, m->indexSize) != EXIT_SUCCESS)
+    {
+        // Sense índex, findClass() el tornarà a crear
+        free(m->index);
+        m->index = NULL;
+        m->indexSize = 0;
+    }
+}
+
+// Afegeix un treball acabat: un procés aperiòdic o cada treball d'una
+// tasca periòdica. El temps de retorn és el que passa des de l'alliberament
+// fins a la finalització (return_time és l'instant final). Retorna
+// EXIT_FAILURE si no hi ha memòria per a una classe o un histograma.
+int record_metrics(Metrics *m, const Process *proc)
+{
+    double turnaround = proc->return_time - proc->release;
+    double values[NUM_METRICS] = {
+        [METRIC_WAITING] = proc->waiting_time,
+        [METRIC_RESPONSE] = proc->response_time,
+        [METRIC_RETURN] = turnaround,
+        [METRIC_RETURN_N] = proc->burst > 0 ? turnaround / proc->burst : 0,
+        [METRIC_MAX_WAIT] = proc->max_wait,
+    };
+    if (proc->return_time > m->end)
+    {
+        m->end = proc->return_time;
+    }
+    // El repartiment es compta un cop, amb tot el que ha rebut el procés
+    bool share = proc->completed && proc->entitled > 0;
+    MetricClass *c = NULL;
+    if (m->byClass || share)
+    {
+        c = findClass(m, proc->priority);
+        if (c == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        if (stat_add(&m->all[i], values[i]) != EXIT_SUCCESS ||
+            (m->byClass && stat_add(&c->stat[i], values[i]) != EXIT_SUCCESS))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (proc->deadline > 0)
+    {
+        double lateness = proc->return_time - ((double)proc->release + proc->deadline);
+        if (signedstat_add(&m->lateness, lateness) != EXIT_SUCCESS ||
+            stat_add(&m->tardiness, lateness > 0 ? lateness : 0) != EXIT_SUCCESS)
+        {
+            return EXIT_FAILURE;
+        }
+        m->misses += lateness > 0;
+    }
+    if (share)
+    {
+        double received = (double)proc->burst * proc->jobs;
+        if (stat_add(&m->share, 100 * received / proc->entitled) != EXIT_SUCCESS)
+        {
+            return EXIT_FAILURE;
+        }
+        m->received += received;
+        m->entitled += proc->entitled;
+        c->received += received;
+        c->entitled += proc->entitled;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void printSummaryRow(OutBuf *ob, const char *label, const char *metric, const StatSummary *s)
+{
+    outbuf_printf(ob, "|%-8s|%-8s|%10zu|%10.3f|%10.3f|%10.3f", label, metric, s->n, s->mean, s->stddev, s->min);
+    for (size_t p = 0; p < NUM_PERCENTILES; p++)
+    {
+        outbuf_printf(ob, "|%10.3f", s->percentiles[p]);
+    }
+    outbuf_printf(ob, "|%10.3f|\n", s->max);
+}
+
+static void printStatRow(OutBuf *ob, const char *label, const char *metric, const Stat *s)
+{
+    StatSummary summary;
+    stat_summary(s, &summary);
+    printSummaryRow(ob, label, metric, &summary);
+}
+
+static void printShareRow(OutBuf *ob, const char *label, double received, double entitled)
+{
+    outbuf_printf(ob, "|%-8s|%12.1f|%12.1f|%8.3f|\n", label, received, entitled,
+                  entitled > 0 ? received / entitled : 0.0);
+}
+
+// Repartiment per prioritat: temps de CPU rebut i el que corresponia
+static void writeShares(OutBuf *ob, const Metrics *m)
+{
+    outbuf_printf(ob, "%-14s", "== SHARES ");
+    outbuf_repeat(ob, '=', 30);
+    outbuf_putc(ob, '\n');
+    outbuf_printf(ob, "|%-8s|%12s|%12s|%8s|\n", "class", "received", "entitled", "ratio");
+    for (size_t c = 0; c < m->nclasses; c++)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "prio %d", m->classes[c].priority);
+        printShareRow(ob, label, m->classes[c].received, m->classes[c].entitled);
+    }
+    printShareRow(ob, "all", m->received, m->entitled);
+}
+
+void writeMetrics(OutBuf *ob, const Metrics *m)
+{
+    outbuf_printf(ob, "%-14s", "== METRICS ");
+    outbuf_repeat(ob, '=', 5 * 24);
+    outbuf_putc(ob, '\n');
+
+    outbuf_printf(ob, "|%-8s|%-8s|%10s|%10s|%10s|%10s", "class", "metric", "n", "mean", "stddev", "min");
+    for (size_t p = 0; p < NUM_PERCENTILES; p++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "p%g", metricsPercentiles[p]);
+        outbuf_printf(ob, "|%10s", name);
+    }
+    outbuf_printf(ob, "|%10s|\n", "max");
+
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        printStatRow(ob, "all", metricsNames[i], &m->all[i]);
+    }
+    for (size_t c = 0; m->byClass && c < m->nclasses; c++)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "prio %d", m->classes[c].priority);
+        for (int i = 0; i < NUM_METRICS; i++)
+        {
+            printStatRow(ob, label, metricsNames[i], &m->classes[c].stat[i]);
+        }
+    }
+    if (m->tardiness.n > 0)
+    {
+        StatSummary lateness;
+        signedstat_summary(&m->lateness, &lateness);
+        printSummaryRow(ob, "all", "lateness", &lateness);
+        printStatRow(ob, "all", "tardy", &m->tardiness);
+    }
+    if (m->share.n > 0)
+    {
+        printStatRow(ob, "all", "share%", &m->share);
+        writeShares(ob, m);
+    }
+    if (m->tardiness.n > 0)
+    {
+        outbuf_printf(ob, "%-14s", "== DEADLINES ");
+        outbuf_repeat(ob, '=', 30);
+        outbuf_putc(ob, '\n');
+        outbuf_printf(ob, "jobs %zu, missed %zu (%.2f%%)\n", m->tardiness.n, m->misses,
+                      100.0 * (double)m->misses / (double)m->tardiness.n);
+    }
+}
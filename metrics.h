@@ -0,0 +1,113 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "process.h"
+#include "outbuf.h"
+
+// Mètriques que s'acumulen a cada procés acabat. maxwait és l'espera més
+// llarga d'una sola vegada a la cua de preparats: mesura la inanició.
+enum metrics{METRIC_WAITING, METRIC_RESPONSE, METRIC_RETURN, METRIC_RETURN_N, METRIC_MAX_WAIT};
+static const char * const metricsNames[] = {
+	[METRIC_WAITING] = "waiting",
+	[METRIC_RESPONSE] = "response",
+	[METRIC_RETURN] = "return",
+	[METRIC_RETURN_N] = "returnN",
+	[METRIC_MAX_WAIT] = "maxwait",
+};
+#define NUM_METRICS 5
+
+// Percentils que es mostren
+static const double metricsPercentiles[] = {50, 95, 99, 99.9};
+#define NUM_PERCENTILES (sizeof(metricsPercentiles) / sizeof(double))
+
+// Histograma logarítmic: cada potència de 2 es divideix en
+// STAT_SUBBUCKETS intervals, de manera que un percentil té un error
+// relatiu menor que 1/STAT_SUBBUCKETS. L'interval 0 recull els valors < 1.
+#define STAT_SUBBUCKETS 16
+#define STAT_BUCKETS (1 + 64 * STAT_SUBBUCKETS)
+
+// Estadístic en línia: mitjana i variància de Welford més l'histograma.
+// Només es reserva la finestra d'intervals entre el mínim i el màxim (per
+// octaves senceres): els valors d'una classe solen ocupar-ne poques.
+typedef struct _stat
+{
+    size_t n;
+    double mean;
+    double m2;
+    double min;
+    double max;
+    size_t *buckets;        // intervals [first, first + count) de l'histograma
+    size_t first;
+    size_t count;
+} Stat;
+
+// Estadístic de valors amb signe (p.ex. el retard respecte del termini,
+// negatiu si s'acaba abans). L'histograma només admet valors positius: els
+// negatius s'hi guarden canviats de signe en un de separat.
+typedef struct _signedstat
+{
+    Stat all;               // mitjana, variància i extrems de tots els valors
+    Stat below;             // -valor dels negatius
+    Stat above;             // els positius i els zeros
+} SignedStat;
+
+// Resum d'un estadístic tal com es mostra
+typedef struct _statsummary
+{
+    size_t n;
+    double mean;
+    double stddev;
+    double min;
+    double percentiles[NUM_PERCENTILES];
+    double max;
+} StatSummary;
+
+typedef struct _metricclass
+{
+    int priority;
+    Stat stat[NUM_METRICS]; // buits si no es demanen per classe
+    double received;        // temps de CPU rebut pels processos amb repartiment
+    double entitled;        // temps de CPU que els corresponia
+} MetricClass;
+
+// Mètriques d'una simulació, globals i per prioritat. No guarden cap
+// procés: la memòria no depèn de la mida de la taula. Les classes només
+// es creen per a les mètriques per prioritat (byClass) o el repartiment.
+typedef struct _metricset
+{
+    Stat all[NUM_METRICS];
+    bool byClass;           // mètriques també per prioritat (-v)
+    MetricClass *classes;   // per ordre d'aparició; sort_metrics() les ordena per prioritat
+    size_t nclasses;
+    size_t capacity;
+    size_t *index;          // taula de dispersió per prioritat: posició a classes + 1, 0 si és lliure
+    size_t indexSize;       // potència de 2, com a mínim el doble de nclasses
+    int end;                // instant de la darrera finalització
+    // Polítiques proporcionals: percentatge rebut / corresponent de cada
+    // procés amb Process.entitled > 0, i els totals
+    Stat share;
+    double received;
+    double entitled;
+    // Terminis: retard (fi - termini absolut) i tardança (el retard si és
+    // positiu) de cada treball amb termini, i els que l'han incomplert
+    SignedStat lateness;
+    Stat tardiness;
+    size_t misses;
+} Metrics;
+
+void init_metrics(Metrics *m, bool byClass);
+void clean_metrics(Metrics *m);
+int record_metrics(Metrics *m, const Process *proc);
+void sort_metrics(Metrics *m);
+int stat_add(Stat *s, double value);
+double stat_stddev(const Stat *s);
+double stat_percentile(const Stat *s, double p);
+void stat_summary(const Stat *s, StatSummary *summary);
+int signedstat_add(SignedStat *s, double value);
+double signedstat_percentile(const SignedStat *s, double p);
+void signedstat_summary(const SignedStat *s, StatSummary *summary);
+void writeMetrics(OutBuf *ob, const Metrics *m);
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "scheduler.h"
+#include "policy.h"
+
+// Cua multinivell amb realimentació, a l'estil del planificador O(1) de
+// Linux: cada CPU té una cua FIFO per nivell i un mapa de bits amb els
+// nivells no buits, de manera que el següent procés és el primer del
+// nivell indicat pel bit més baix, sense recórrer res.
+//
+// Tots els processos comencen al nivell 0. El nivell l té un tram de
+// quantum << l; qui l'esgota baixa un nivell. El temps consumit en un
+// nivell es conserva si el procés deixa la CPU abans (E/S o expulsió),
+// de manera que no es pot mantenir a dalt cedint la CPU just abans.
+// En mode preemptiu, un procés d'un nivell superior expulsa el que
+// s'executa.
+#define MLFQ_LEVELS 8
+
+typedef struct _mlfq
+{
+    Queue *queues;          // queues[cpu * MLFQ_LEVELS + nivell]
+    uint32_t *bitmap;       // bit l de bitmap[cpu]: el nivell l té processos
+    size_t *sizes;          // preparats de cada CPU
+    unsigned char *level;   // nivell de cada procés (posició a la taula)
+    int *used;              // temps consumit al nivell actual
+} Mlfq;
+
+static void mlfqClean(SimContext *ctx)
+{
+    Mlfq *m = ctx->policy_state;
+    if (m == NULL)
+    {
+        return;
+    }
+    free(m->queues);
+    free(m->bitmap);
+    free(m->sizes);
+    free(m->level);
+    free(m->used);
+    free(m);
+    ctx->policy_state = NULL;
+}
+
+static int mlfqInit(SimContext *ctx)
+{
+    size_t ncpus = (size_t)ctx->ncpus;
+    size_t nprocs = ctx->nprocs > 0 ? ctx->nprocs : 1;
+    Mlfq *m = calloc(1, sizeof(Mlfq));
+    ctx->policy_state = m;
+    if (m == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    m->queues = calloc(ncpus * MLFQ_LEVELS, sizeof(Queue));
+    m->bitmap = calloc(ncpus, sizeof(uint32_t));
+    m->sizes = calloc(ncpus, sizeof(size_t));
+    m->level = calloc(nprocs, sizeof(unsigned char));
+    m->used = calloc(nprocs, sizeof(int));
+    if (m->queues == NULL || m->bitmap == NULL || m->sizes == NULL || m->level == NULL || m->used == NULL)
+    {
+        mlfqClean(ctx);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Les cues són de l'arena de l'execució; els nivells tornen a 0
+static int mlfqStart(SimContext *ctx)
+{
+    Mlfq *m = ctx->policy_state;
+    for (size_t i = 0; i < (size_t)ctx->ncpus * MLFQ_LEVELS; i++)
+    {
+        if (init_queue_arena(&m->queues[i], &ctx->arena) != EXIT_SUCCESS)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    memset(m->bitmap, 0, (size_t)ctx->ncpus * sizeof(uint32_t));
+    memset(m->sizes, 0, (size_t)ctx->ncpus * sizeof(size_t));
+    memset(m->level, 0, ctx->nprocs * sizeof(unsigned char));
+    memset(m->used, 0, ctx->nprocs * sizeof(int));
+    return EXIT_SUCCESS;
+}
+
+// Tram del nivell: quantum << level, limitat a INT_MAX perquè un -q gran
+// no desbordi als nivells baixos
+static int allotment(SimContext *ctx, int level)
+{
+    int quantum = ctx->options.quantum > 0 ? ctx->options.quantum : 1;
+    return quantum > (INT_MAX >> level) ? INT_MAX : quantum << level;
+}
+
+static int mlfqArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    Mlfq *m = ctx->policy_state;
+    int level = m->level[p - ctx->procTable];
+    if (enqueue(&m->queues[c->id * MLFQ_LEVELS + level], p) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+    m->bitmap[c->id] |= 1u << level;
+    m->sizes[c->id]++;
+    return EXIT_SUCCESS;
+}
+
+static Process *mlfqPick(SimContext *ctx, CPU *c, int *slice)
+{
+    Mlfq *m = ctx->policy_state;
+    uint32_t bits = m->bitmap[c->id];
+    if (bits == 0)
+    {
+        return NULL;
+    }
+    int level = __builtin_ctz(bits);
+    Queue *q = &m->queues[c->id * MLFQ_LEVELS + level];
+    Process *p = dequeue(q);
+    if (get_queue_size(q) == 0)
+    {
+        m->bitmap[c->id] &= ~(1u << level);
+    }
+    m->sizes[c->id]--;
+    *slice = allotment(ctx, level) - m->used[p - ctx->procTable];
+    return p;
+}
+
+// En esgotar el tram del nivell, el procés baixa (si no és a l'últim)
+static void mlfqTick(SimContext *ctx, CPU *c, Process *p, int ran)
+{
+    Mlfq *m = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    m->used[order] += ran;
+    if (m->used[order] >= allotment(ctx, m->level[order]))
+    {
+        m->used[order] = 0;
+        if (m->level[order] + 1 < MLFQ_LEVELS)
+        {
+            m->level[order]++;
+        }
+    }
+}
+
+// Un procés que acaba del tot deixa la posició al nivell 0
+static void mlfqComplete(SimContext *ctx, CPU *c, Process *p)
+{
+    Mlfq *m = ctx->policy_state;
+    if (p->completed)
+    {
+        m->level[p - ctx->procTable] = 0;
+        m->used[p - ctx->procTable] = 0;
+    }
+}
+
+// Hi ha algun nivell no buit per sobre del de running
+static bool mlfqPreempts(SimContext *ctx, CPU *c, Process *running)
+{
+    Mlfq *m = ctx->policy_state;
+    if (ctx->options.modality != PREEMPTIVE)
+    {
+        return false;
+    }
+    uint32_t above = (1u << m->level[running - ctx->procTable]) - 1;
+    return (m->bitmap[c->id] & above) != 0;
+}
+
+static size_t mlfqSize(SimContext *ctx, CPU *c)
+{
+    Mlfq *m = ctx->policy_state;
+    return m->sizes[c->id];
+}
+
+const Policy mlfqPolicy = {
+    .name = "mlfq",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .quantum = true,
+    .init = mlfqInit,
+    .start = mlfqStart,
+    .clean = mlfqClean,
+    .on_arrival = mlfqArrival,
+    .pick_next = mlfqPick,
+    .on_tick = mlfqTick,
+    .preempts = mlfqPreempts,
+    .on_preempt = mlfqArrival,
+    .on_complete = mlfqComplete,
+    .size = mlfqSize,
+};
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "outbuf.h"
+
+int init_outbuf(OutBuf *ob, FILE *out)
+{
+    ob->out = out;
+    ob->size = 0;
+    ob->data = malloc(OUTBUF_CAPACITY);
+    ob->capacity = ob->data != NULL ? OUTBUF_CAPACITY : 0;
+    return ob->data != NULL ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void outbuf_flush(OutBuf *ob)
+{
+    if (ob->size > 0)
+    {
+        fwrite(ob->data, 1, ob->size, ob->out);
+        ob->size = 0;
+    }
+}
+
+void outbuf_write(OutBuf *ob, const char *s, size_t len)
+{
+    if (ob->size + len > ob->capacity)
+    {
+        outbuf_flush(ob);
+        if (len > ob->capacity)
+        {
+            fwrite(s, 1, len, ob->out);
+            return;
+        }
+    }
+    memcpy(ob->data + ob->size, s, len);
+    ob->size += len;
+}
+
+void outbuf_puts(OutBuf *ob, const char *s)
+{
+    outbuf_write(ob, s, strlen(s));
+}
+
+void outbuf_repeat(OutBuf *ob, char c, size_t n)
+{
+    while (n > 0)
+    {
+        if (ob->size == ob->capacity)
+        {
+            outbuf_flush(ob);
+        }
+        size_t chunk = ob->capacity - ob->size < n ? ob->capacity - ob->size : n;
+        memset(ob->data + ob->size, c, chunk);
+        ob->size += chunk;
+        n -= chunk;
+    }
+}
+
+// Es formata directament dins del buffer; si no hi cap, es buida i es
+// torna a provar (una línia que no càpiga sencera va per un bloc temporal)
+void outbuf_printf(OutBuf *ob, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(ob->data + ob->size, ob->capacity - ob->size, fmt, args);
+    va_end(args);
+    if (len < 0)
+    {
+        return;
+    }
+    if ((size_t)len < ob->capacity - ob->size)
+    {
+        ob->size += (size_t)len;
+        return;
+    }
+    outbuf_flush(ob);
+    va_start(args, fmt);
+    if ((size_t)len < ob->capacity)
+    {
+        vsnprintf(ob->data, ob->capacity, fmt, args);
+        ob->size = (size_t)len;
+    }
+    else
+    {
+        vfprintf(ob->out, fmt, args);
+    }
+    va_end(args);
+}
+
+void clean_outbuf(OutBuf *ob)
+{
+    outbuf_flush(ob);
+    fflush(ob->out);
+    free(ob->data);
+    ob->data = NULL;
+    ob->capacity = 0;
+}
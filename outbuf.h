@@ -0,0 +1,37 @@
+#ifndef _OUTBUF_H_
+#define _OUTBUF_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Buffer de sortida: tot el que s'escriu s'acumula en un únic bloc gran i
+// només es bolca al fitxer quan és ple o en acabar, amb una sola fwrite.
+#define OUTBUF_CAPACITY (1 << 20)
+
+typedef struct _outbuf
+{
+    FILE *out;
+    char *data;
+    size_t size;
+    size_t capacity;
+} OutBuf;
+
+int init_outbuf(OutBuf *ob, FILE *out);
+void outbuf_write(OutBuf *ob, const char *s, size_t len);
+void outbuf_puts(OutBuf *ob, const char *s);
+void outbuf_printf(OutBuf *ob, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void outbuf_repeat(OutBuf *ob, char c, size_t n);
+void outbuf_flush(OutBuf *ob);
+void clean_outbuf(OutBuf *ob);
+
+// Afegeix un caràcter sense passar per cap crida (camí ràpid de les cel·les)
+static inline void outbuf_putc(OutBuf *ob, char c)
+{
+    if (ob->size == ob->capacity)
+    {
+        outbuf_flush(ob);
+    }
+    ob->data[ob->size++] = c;
+}
+
+#endif
@@ -0,0 +1,456 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "output.h"
+
+int num_formats()
+{
+    return sizeof(formatsNames) / sizeof(char *);
+}
+
+static void writeTitle(OutBuf *ob, const char *title, size_t columns)
+{
+    outbuf_printf(ob, "%14s", title);
+    outbuf_repeat(ob, '=', 5 * columns);
+    outbuf_putc(ob, '\n');
+}
+
+// Format clàssic: una cel·la "|xx" per instant
+static void writeClassicGantt(OutBuf *ob, const SimContext *ctx, size_t duration)
+{
+    writeTitle(ob, "== SIMULATION ", duration);
+    outbuf_printf(ob, "|%4s", "name");
+    for (size_t t = 0; t < duration; t++)
+    {
+        outbuf_printf(ob, "|%2zu", t);
+    }
+    outbuf_puts(ob, "|\n");
+
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        const Process *current = &ctx->procTable[p];
+        outbuf_printf(ob, "|%4s", current->name);
+        // Els trams estan ordenats: es recorren una sola vegada junt amb t
+        size_t s = 0;
+        for (int t = 0; t < (int)duration; t++)
+        {
+            while (s < current->lifecycle_size && current->lifecycle[s].end <= t)
+            {
+                s++;
+            }
+            int state = (s < current->lifecycle_size && current->lifecycle[s].start <= t) ? current->lifecycle[s].state : -1;
+            outbuf_puts(ob, state == Running ? "| E" : state == Bloqued ? "| B" : state == Finished ? "| F" : "|  ");
+        }
+        outbuf_puts(ob, "|\n");
+    }
+
+    if (ctx->ncpus <= 1)
+    {
+        return;
+    }
+
+    // Línia de temps de cada processador: id del procés que hi executa
+    int *cells = malloc(duration * (size_t)ctx->ncpus * sizeof(int));
+    if (cells == NULL)
+    {
+        return;
+    }
+    for (size_t t = 0; t < duration * (size_t)ctx->ncpus; t++)
+    {
+        cells[t] = -1;
+    }
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        const Process *current = &ctx->procTable[p];
+        for (size_t s = 0; s < current->lifecycle_size; s++)
+        {
+            Segment segment = current->lifecycle[s];
+            if (segment.state != Running || segment.cpu < 0 || segment.cpu >= ctx->ncpus)
+            {
+                continue;
+            }
+            for (int t = segment.start; t < segment.end && t < (int)duration; t++)
+            {
+                cells[(size_t)segment.cpu * duration + (size_t)t] = current->id;
+            }
+        }
+    }
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "C%d", c);
+        outbuf_printf(ob, "|%4s", label);
+        for (size_t t = 0; t < duration; t++)
+        {
+            int id = cells[(size_t)c * duration + t];
+            if (id >= 0)
+            {
+                outbuf_printf(ob, "|%2d", id);
+            }
+            else
+            {
+                outbuf_puts(ob, "|  ");
+            }
+        }
+        outbuf_puts(ob, "|\n");
+    }
+    free(cells);
+}
+
+// Suma a busy[col] els instants de [start, end) que cauen a cada columna
+static void addCoverage(size_t *busy, int start, int end, size_t duration, size_t scale)
+{
+    size_t from = (size_t)start;
+    size_t to = (size_t)end < duration ? (size_t)end : duration;
+    while (from < to)
+    {
+        size_t col = from / scale;
+        size_t limit = (col + 1) * scale < to ? (col + 1) * scale : to;
+        busy[col] += limit - from;
+        from = limit;
+    }
+}
+
+static char coverageGlyph(size_t covered, size_t length, char full, char partial)
+{
+    return covered == 0 ? ' ' : covered >= length ? full : partial;
+}
+
+// Una columna de cada fila: el glif ple si s'ha ocupat tota la columna,
+// el parcial si només una part, i espai si gens. Si es dona blocked, les
+// columnes sense execució mostren l'E/S (B o b).
+static void writeCoverageRow(OutBuf *ob, const char *label, const size_t *busy, const size_t *blocked,
+                             size_t columns, size_t duration, size_t scale, char full, char partial)
+{
+    outbuf_printf(ob, "|%4s|", label);
+    for (size_t col = 0; col < columns; col++)
+    {
+        size_t length = (col + 1) * scale <= duration ? scale : duration - col * scale;
+        char glyph = coverageGlyph(busy[col], length, full, partial);
+        if (glyph == ' ' && blocked != NULL)
+        {
+            glyph = coverageGlyph(blocked[col], length, 'B', 'b');
+        }
+        outbuf_putc(ob, glyph);
+    }
+    outbuf_puts(ob, "|\n");
+}
+
+// Format compacte: un caràcter per columna i cada columna agrupa scale
+// instants. Una regla marca l'instant inicial cada 10 columnes.
+static void writeScaledGantt(OutBuf *ob, const SimContext *ctx, size_t duration, size_t width)
+{
+    size_t scale = (duration + width - 1) / width;
+    size_t columns = (duration + scale - 1) / scale;
+    size_t *busy = calloc(columns * (size_t)(ctx->ncpus + 2), sizeof(size_t));
+    char *ruler = malloc(columns + 16);
+    if (busy == NULL || ruler == NULL)
+    {
+        free(busy);
+        free(ruler);
+        return;
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "== SIMULATION (1 column = %zu ticks) ", scale);
+    outbuf_puts(ob, title);
+    outbuf_repeat(ob, '=', columns + 6 > strlen(title) ? columns + 6 - strlen(title) : 0);
+    outbuf_putc(ob, '\n');
+
+    memset(ruler, ' ', columns);
+    for (size_t col = 0; col < columns; col += 10)
+    {
+        char label[24];
+        int len = snprintf(label, sizeof(label), "%zu", col * scale);
+        if (col + (size_t)len <= columns)
+        {
+            memcpy(ruler + col, label, (size_t)len);
+        }
+    }
+    outbuf_printf(ob, "|%4s|", "time");
+    outbuf_write(ob, ruler, columns);
+    outbuf_puts(ob, "|\n");
+
+    size_t *blocked = busy + columns;
+    size_t *cpuBusy = blocked + columns;
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        const Process *current = &ctx->procTable[p];
+        memset(busy, 0, 2 * columns * sizeof(size_t));
+        for (size_t s = 0; s < current->lifecycle_size; s++)
+        {
+            Segment segment = current->lifecycle[s];
+            if (segment.state == Bloqued)
+            {
+                addCoverage(blocked, segment.start, segment.end, duration, scale);
+            }
+            if (segment.state != Running)
+            {
+                continue;
+            }
+            addCoverage(busy, segment.start, segment.end, duration, scale);
+            if (segment.cpu >= 0 && segment.cpu < ctx->ncpus)
+            {
+                addCoverage(cpuBusy + (size_t)segment.cpu * columns, segment.start, segment.end, duration, scale);
+            }
+        }
+        writeCoverageRow(ob, current->name, busy, blocked, columns, duration, scale, 'E', 'e');
+    }
+
+    for (int c = 0; ctx->ncpus > 1 && c < ctx->ncpus; c++)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "C%d", c);
+        writeCoverageRow(ob, label, cpuBusy + (size_t)c * columns, NULL, columns, duration, scale, '#', '+');
+    }
+    free(busy);
+    free(ruler);
+}
+
+void writeGantt(OutBuf *ob, const SimContext *ctx, size_t duration)
+{
+    size_t width = ctx->options.width > 0 ? (size_t)ctx->options.width : GANTT_DEFAULT_WIDTH;
+    if (duration <= width && duration <= GANTT_CLASSIC_MAX)
+    {
+        writeClassicGantt(ob, ctx, duration);
+    }
+    else if (duration > 0)
+    {
+        writeScaledGantt(ob, ctx, duration, width);
+    }
+}
+
+void writeCPUUsage(OutBuf *ob, const CPU *cpus, int ncpus, size_t simulationCPUTime)
+{
+    outbuf_printf(ob, "%-14s", "== CPUS ");
+    // La capçalera segueix l'amplada del Gantt clàssic, fins al seu màxim
+    size_t columns = simulationCPUTime + 1 < GANTT_CLASSIC_MAX ? simulationCPUTime + 1 : GANTT_CLASSIC_MAX;
+    outbuf_repeat(ob, '=', 5 * columns);
+    outbuf_putc(ob, '\n');
+    for (int c = 0; c < ncpus; c++)
+    {
+        double usage = simulationCPUTime > 0 ? (double)cpus[c].busy / (double)simulationCPUTime : 0;
+        outbuf_printf(ob, "= CPU %d (Usage): %lf\n", c, usage * 100);
+    }
+}
+
+static const char * const stateNames[] = {"ready", "running", "blocked", "finished"};
+
+// Polítiques proporcionals: temps de CPU rebut (burst per treball), el que
+// li corresponia i la desviació en percentatge del que li corresponia
+static double shareReceived(const Process *p)
+{
+    return (double)p->burst * p->jobs;
+}
+
+static double shareDeviation(const Process *p)
+{
+    return 100 * (shareReceived(p) - p->entitled) / p->entitled;
+}
+
+// Camp CSV segons RFC 4180: entre cometes si conté una coma, cometes o un
+// salt de línia, amb les cometes doblades
+static void writeCSVField(OutBuf *ob, const char *s)
+{
+    if (strpbrk(s, ",\"\r\n") == NULL)
+    {
+        outbuf_puts(ob, s);
+        return;
+    }
+    outbuf_putc(ob, '"');
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '"')
+        {
+            outbuf_putc(ob, '"');
+        }
+        outbuf_putc(ob, *s);
+    }
+    outbuf_putc(ob, '"');
+}
+
+// Un tram per línia: id,name,state,cpu,start,end (cpu -1 durant l'E/S). Amb
+// les polítiques proporcionals (share), cada línia porta també
+// received,entitled,deviation del seu procés.
+void writeCSVHeader(OutBuf *ob, bool share)
+{
+    outbuf_puts(ob, share ? "id,name,state,cpu,start,end,received,entitled,deviation\n" : "id,name,state,cpu,start,end\n");
+}
+
+void writeProcessCSV(OutBuf *ob, const Process *p, bool share)
+{
+    for (size_t s = 0; s < p->lifecycle_size; s++)
+    {
+        Segment segment = p->lifecycle[s];
+        outbuf_printf(ob, "%d,", p->id);
+        writeCSVField(ob, p->name);
+        outbuf_printf(ob, ",%s,%d,%d,%d", stateNames[segment.state], segment.cpu, segment.start, segment.end);
+        if (share && p->entitled > 0)
+        {
+            outbuf_printf(ob, ",%.6g,%.6g,%.6g", shareReceived(p), p->entitled, shareDeviation(p));
+        }
+        else if (share)
+        {
+            outbuf_puts(ob, ",,,");
+        }
+        outbuf_putc(ob, '\n');
+    }
+}
+
+void writeSegmentsCSV(OutBuf *ob, const SimContext *ctx)
+{
+    writeCSVHeader(ob, ctx->policy->share);
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        writeProcessCSV(ob, &ctx->procTable[p], ctx->policy->share);
+    }
+}
+
+static void writeJSONString(OutBuf *ob, const char *s)
+{
+    outbuf_putc(ob, '"');
+    for (; *s != '\0'; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            outbuf_putc(ob, '\\');
+            outbuf_putc(ob, (char)c);
+        }
+        else if (c < 0x20)
+        {
+            outbuf_printf(ob, "\\u%04x", c);
+        }
+        else
+        {
+            outbuf_putc(ob, (char)c);
+        }
+    }
+    outbuf_putc(ob, '"');
+}
+
+static void writeJSONSummary(OutBuf *ob, const StatSummary *s)
+{
+    outbuf_printf(ob, "{\"n\":%zu,\"mean\":%.6g,\"stddev\":%.6g,\"min\":%.6g", s->n, s->mean, s->stddev, s->min);
+    for (size_t p = 0; p < NUM_PERCENTILES; p++)
+    {
+        outbuf_printf(ob, ",\"p%g\":%.6g", metricsPercentiles[p], s->percentiles[p]);
+    }
+    outbuf_printf(ob, ",\"max\":%.6g}", s->max);
+}
+
+static void writeJSONStat(OutBuf *ob, const Stat *s)
+{
+    StatSummary summary;
+    stat_summary(s, &summary);
+    writeJSONSummary(ob, &summary);
+}
+
+static void writeJSONMetrics(OutBuf *ob, const Stat *stat)
+{
+    outbuf_putc(ob, '{');
+    for (int i = 0; i < NUM_METRICS; i++)
+    {
+        outbuf_printf(ob, "%s\"%s\":", i > 0 ? "," : "", metricsNames[i]);
+        writeJSONStat(ob, &stat[i]);
+    }
+    outbuf_putc(ob, '}');
+}
+
+// Un objecte JSON amb la configuració, els processos amb els seus trams,
+// els resultats, les mètriques (globals i, amb -v, per prioritat) i les
+// CPUs. Els processos van abans que els resultats perquè, amb un flux,
+// s'escriuen a mesura que acaben (writeJSONHead(), writeProcessJSON() per a
+// cadascun i writeJSONTail()).
+void writeJSONHead(OutBuf *ob, const SimContext *ctx)
+{
+    const SimOptions *o = &ctx->options;
+    outbuf_printf(ob, "{\"algorithm\":\"%s\",\"modality\":\"%s\",\"quantum\":%d,\"ncpus\":%d,\"processes\":[",
+                  algorithm_name(o->algorithm), modalitiesNames[o->modality], o->quantum, ctx->ncpus);
+}
+
+void writeProcessJSON(OutBuf *ob, const Process *p, bool first)
+{
+    outbuf_printf(ob, "%s\n{\"id\":%d,\"name\":", first ? "" : ",", p->id);
+    writeJSONString(ob, p->name);
+    outbuf_printf(ob, ",\"priority\":%d,\"arrive\":%d,\"burst\":%d,\"io\":%d,\"waiting\":%d,\"response\":%d,\"end\":%d,"
+                  "\"maxwait\":%d,",
+                  p->priority, p->arrive_time, p->burst, p->io_time, p->waiting_time, p->response_time, p->return_time,
+                  p->max_wait);
+    if (p->deadline > 0 || p->period > 0)
+    {
+        // Tasques amb termini o periòdiques: els temps són del darrer treball
+        outbuf_printf(ob, "\"deadline\":%d,\"period\":%d,\"jobs\":%d,", p->deadline, p->period, p->jobs);
+    }
+    if (p->entitled > 0)
+    {
+        outbuf_printf(ob, "\"received\":%.6g,\"entitled\":%.6g,\"deviation\":%.6g,", shareReceived(p), p->entitled,
+                      shareDeviation(p));
+    }
+    outbuf_puts(ob, "\"segments\":[");
+    for (size_t s = 0; s < p->lifecycle_size; s++)
+    {
+        Segment segment = p->lifecycle[s];
+        outbuf_printf(ob, "%s[%d,%d,%d,\"%s\"]", s > 0 ? "," : "", segment.start, segment.end, segment.cpu,
+                      stateNames[segment.state]);
+    }
+    outbuf_puts(ob, "]}");
+}
+
+void writeJSONTail(OutBuf *ob, const SimContext *ctx)
+{
+    const SimResults *r = &ctx->results;
+    outbuf_printf(ob, "],\"results\":{\"nprocs\":%zu,\"duration\":%zu,\"events\":%zu,\"waiting\":%.6g,\"response\":%.6g,"
+                  "\"return\":%.6g,\"returnN\":%.6g,\"maxwait\":%.6g,\"throughput\":%.6g,\"cpu\":%.6g},",
+                  r->nprocs, r->duration, r->events, r->averageWaitingTime, r->averageResponseTime,
+                  r->averageReturnTime, r->averageReturnTimeN, r->maxWaitingTime, r->throughput, r->cpuUsage);
+
+    outbuf_puts(ob, "\"metrics\":");
+    writeJSONMetrics(ob, ctx->metrics.all);
+    outbuf_puts(ob, ",\"classes\":[");
+    for (size_t c = 0; c < ctx->metrics.nclasses; c++)
+    {
+        outbuf_printf(ob, "%s{\"priority\":%d", c > 0 ? "," : "", ctx->metrics.classes[c].priority);
+        if (ctx->metrics.byClass)
+        {
+            outbuf_puts(ob, ",\"metrics\":");
+            writeJSONMetrics(ob, ctx->metrics.classes[c].stat);
+        }
+        if (ctx->metrics.share.n > 0)
+        {
+            outbuf_printf(ob, ",\"received\":%.6g,\"entitled\":%.6g", ctx->metrics.classes[c].received,
+                          ctx->metrics.classes[c].entitled);
+        }
+        outbuf_putc(ob, '}');
+    }
+
+    outbuf_putc(ob, ']');
+    if (ctx->metrics.tardiness.n > 0)
+    {
+        StatSummary lateness;
+        signedstat_summary(&ctx->metrics.lateness, &lateness);
+        outbuf_printf(ob, ",\"deadlines\":{\"jobs\":%zu,\"missed\":%zu,\"lateness\":", ctx->metrics.tardiness.n,
+                      ctx->metrics.misses);
+        writeJSONSummary(ob, &lateness);
+        outbuf_puts(ob, ",\"tardiness\":");
+        writeJSONStat(ob, &ctx->metrics.tardiness);
+        outbuf_putc(ob, '}');
+    }
+
+    outbuf_puts(ob, ",\"cpus\":[");
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        outbuf_printf(ob, "%s{\"id\":%d,\"busy\":%zu}", c > 0 ? "," : "", c, ctx->cpus[c].busy);
+    }
+    outbuf_puts(ob, "]}\n");
+}
+
+void writeJSON(OutBuf *ob, const SimContext *ctx)
+{
+    writeJSONHead(ob, ctx);
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        writeProcessJSON(ob, &ctx->procTable[p], p == 0);
+    }
+    writeJSONTail(ob, ctx);
+}
@@ -0,0 +1,32 @@
+#ifndef _OUTPUT_H_
+#define _OUTPUT_H_
+
+#include "outbuf.h"
+#include "scheduler.h"
+
+// Formats de sortida d'una simulació
+enum formats{FORMAT_GANTT, FORMAT_CSV, FORMAT_JSON};
+static const char * const formatsNames[] = {
+	[FORMAT_GANTT] = "gantt",
+	[FORMAT_CSV] = "csv",
+	[FORMAT_JSON] = "json",
+};
+
+// Amplada màxima del diagrama de Gantt clàssic (una columna per instant).
+// Per sobre, o si l'amplada demanada és menor, cada columna agrupa
+// diversos instants.
+#define GANTT_CLASSIC_MAX 100
+#define GANTT_DEFAULT_WIDTH 100
+
+int num_formats(void);
+void writeGantt(OutBuf *ob, const SimContext *ctx, size_t duration);
+void writeCPUUsage(OutBuf *ob, const CPU *cpus, int ncpus, size_t simulationCPUTime);
+void writeCSVHeader(OutBuf *ob, bool share);
+void writeProcessCSV(OutBuf *ob, const Process *p, bool share);
+void writeSegmentsCSV(OutBuf *ob, const SimContext *ctx);
+void writeJSONHead(OutBuf *ob, const SimContext *ctx);
+void writeProcessJSON(OutBuf *ob, const Process *p, bool first);
+void writeJSONTail(OutBuf *ob, const SimContext *ctx);
+void writeJSON(OutBuf *ob, const SimContext *ctx);
+
+#endif
@@ -0,0 +1,296 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "scheduler.h"
+#include "policy.h"
+
+// Les predefinides ocupen les posicions de enum algorithms; una política
+// nova només cal afegir-la al final
+static const Policy * const policies[] = {
+    [FCFS] = &fcfsPolicy,
+    [SJF] = &sjfPolicy,
+    [RR] = &rrPolicy,
+    [PRIORITIES] = &prioritiesPolicy,
+    &mlfqPolicy,
+    &cfsPolicy,
+    &lotteryPolicy,
+    &stridePolicy,
+    &edfPolicy,
+    &rmPolicy,
+};
+
+// Pes de cada nice, de -20 a 19 (cada nivell és un 25% aprox.), com a Linux
+static const int niceWeights[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906,
+    3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423,
+    335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45,
+    36, 29, 23, 18, 15,
+};
+
+int num_policies(void)
+{
+    return sizeof(policies) / sizeof(Policy *);
+}
+
+const Policy *get_policy(int algorithm)
+{
+    return algorithm >= 0 && algorithm < num_policies() ? policies[algorithm] : NULL;
+}
+
+// Posició de la política amb aquest nom, o -1
+int find_policy(const char *name)
+{
+    for (int a = 0; a < num_policies(); a++)
+    {
+        if (strcmp(name, policies[a]->name) == 0)
+        {
+            return a;
+        }
+    }
+    return -1;
+}
+
+const char *algorithm_name(int algorithm)
+{
+    const Policy *policy = get_policy(algorithm);
+    return policy != NULL ? policy->name : "?";
+}
+
+bool policy_accepts(const Policy *policy, int modality)
+{
+    return (policy->modalities & (1 << modality)) != 0;
+}
+
+// La modalitat demanada si la política l'admet; si no, l'altra
+int policy_modality(const Policy *policy, int modality)
+{
+    if (policy_accepts(policy, modality))
+    {
+        return modality;
+    }
+    return modality == PREEMPTIVE ? NONPREEMPTIVE : PREEMPTIVE;
+}
+
+// Pes d'un procés per a les polítiques proporcionals: la prioritat es
+// llegeix com el nice de Linux (-20..19; més baixa pesa més, 0 = 1024)
+int policy_weight(const Process *p)
+{
+    int nice = p->priority < -20 ? -20 : p->priority > 19 ? 19 : p->priority;
+    return niceWeights[nice + 20];
+}
+
+// FCFS i RR: la cua FIFO de cada CPU, reservada a l'arena de l'execució
+static int fifoStart(SimContext *ctx)
+{
+    size_t reserve = ctx->ncpus == 1 ? ctx->nprocs : ctx->nprocs / (size_t)ctx->ncpus + 1;
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        if (init_queue_arena(&ctx->cpus[c].fifo, &ctx->arena) != EXIT_SUCCESS ||
+            reserve_queue(&ctx->cpus[c].fifo, reserve) != EXIT_SUCCESS)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+static int fifoArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    return enqueue(&c->fifo, p);
+}
+
+// RR limita el tram al quantum; FCFS el deixa acabar
+static Process *fifoPick(SimContext *ctx, CPU *c, int *slice)
+{
+    *slice = ctx->policy->quantum ? ctx->options.quantum : 0;
+    return dequeue(&c->fifo);
+}
+
+static size_t fifoSize(SimContext *ctx, CPU *c)
+{
+    return get_queue_size(&c->fifo);
+}
+
+// SJF, Prioritats, EDF i RM: el montícle de cada CPU o, amb BACKEND_SCALAR i
+// BACKEND_SIMD, el ReadySet. Els montícles comparteixen ctx->positions.
+static int keyedInit(SimContext *ctx, heap_key key)
+{
+    int kernel = ctx->options.backend == BACKEND_SIMD ? KERNEL_BEST : KERNEL_SCALAR;
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        CPU *cpu = &ctx->cpus[c];
+        if (init_heap(&cpu->heap, ctx->procTable, ctx->nprocs, key, ctx->positions) != EXIT_SUCCESS ||
+            (ctx->useScan && init_readyset(&cpu->ready, ctx->procTable, ctx->nprocs, key, kernel) != EXIT_SUCCESS))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+static int sjfInit(SimContext *ctx)
+{
+    return keyedInit(ctx, remainingKey);
+}
+
+static int prioritiesInit(SimContext *ctx)
+{
+    return keyedInit(ctx, priorityKey);
+}
+
+// EDF: el termini absolut canvia a cada alliberament, però mentre el
+// treball és a la cua no es mou; RM: el període, fix
+static int edfInit(SimContext *ctx)
+{
+    return keyedInit(ctx, deadlineKey);
+}
+
+static int rmInit(SimContext *ctx)
+{
+    return keyedInit(ctx, rateKey);
+}
+
+static int keyedArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    return ctx->useScan ? readyset_push(&c->ready, p) : heap_push(&c->heap, p);
+}
+
+static Process *keyedPick(SimContext *ctx, CPU *c, int *slice)
+{
+    *slice = 0;
+    return ctx->useScan ? readyset_pop(&c->ready) : heap_pop(&c->heap);
+}
+
+// En mode preemptiu, expulsa el primer amb clau menor o, si empaten,
+// anterior a la taula
+static bool keyedPreempts(SimContext *ctx, CPU *c, Process *running)
+{
+    if (ctx->options.modality != PREEMPTIVE)
+    {
+        return false;
+    }
+    if (ctx->useScan)
+    {
+        Process *top = readyset_peek(&c->ready);
+        return top != NULL && readyset_before(&c->ready, top, running);
+    }
+    Process *top = heap_peek(&c->heap);
+    return top != NULL && heap_before(&c->heap, top, running);
+}
+
+static size_t keyedSize(SimContext *ctx, CPU *c)
+{
+    return ctx->useScan ? readyset_size(&c->ready) : heap_size(&c->heap);
+}
+
+// Prioritats amb envelliment: un procés que espera guanya un nivell cada
+// aging unitats, és a dir, a l'instant t val priority - (t - enqueued) / aging.
+// Per a tots els de la cua l'ordre és el de aging * priority + enqueued,
+// que no depèn de t: la clau es calcula un sol cop en encolar i no cal
+// tocar els que esperen a mesura que avança el rellotge.
+static int agedKey(const SimContext *ctx, const Process *p, int enqueued)
+{
+    long long key = (long long)ctx->options.aging * p->priority + enqueued;
+    return key < INT_MIN ? INT_MIN : key > INT_MAX ? INT_MAX : (int)key;
+}
+
+static int prioritiesArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    if (ctx->options.aging <= 0)
+    {
+        return keyedArrival(ctx, c, p);
+    }
+    if (ctx->useScan)
+    {
+        return readyset_push_key(&c->ready, p, agedKey(ctx, p, p->enqueued));
+    }
+    return heap_push_key(&c->heap, p, agedKey(ctx, p, p->enqueued));
+}
+
+// El que s'executa no envelleix: conserva la seva prioritat, com si acabés
+// d'entrar a la cua. Només l'expulsa qui li porta un nivell sencer
+// d'avantatge, de manera que dos processos iguals no s'alternen a cada
+// esdeveniment, sinó cada aging unitats.
+static bool prioritiesPreempts(SimContext *ctx, CPU *c, Process *running)
+{
+    if (ctx->options.aging <= 0)
+    {
+        return keyedPreempts(ctx, c, running);
+    }
+    if (ctx->options.modality != PREEMPTIVE)
+    {
+        return false;
+    }
+    Process *top = ctx->useScan ? readyset_peek(&c->ready) : heap_peek(&c->heap);
+    return top != NULL &&
+           (long long)agedKey(ctx, top, top->enqueued) + ctx->options.aging <= agedKey(ctx, running, ctx->clock);
+}
+
+const Policy fcfsPolicy = {
+    .name = "fcfs",
+    .modalities = 1 << NONPREEMPTIVE,
+    .start = fifoStart,
+    .on_arrival = fifoArrival,
+    .pick_next = fifoPick,
+    .on_preempt = fifoArrival,
+    .size = fifoSize,
+};
+
+const Policy rrPolicy = {
+    .name = "rr",
+    .modalities = 1 << PREEMPTIVE,
+    .quantum = true,
+    .start = fifoStart,
+    .on_arrival = fifoArrival,
+    .pick_next = fifoPick,
+    .on_preempt = fifoArrival,
+    .size = fifoSize,
+};
+
+const Policy sjfPolicy = {
+    .name = "sjf",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .init = sjfInit,
+    .on_arrival = keyedArrival,
+    .pick_next = keyedPick,
+    .preempts = keyedPreempts,
+    .on_preempt = keyedArrival,
+    .size = keyedSize,
+};
+
+const Policy prioritiesPolicy = {
+    .name = "priorities",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .init = prioritiesInit,
+    .on_arrival = prioritiesArrival,
+    .pick_next = keyedPick,
+    .preempts = prioritiesPreempts,
+    .on_preempt = prioritiesArrival,
+    .size = keyedSize,
+};
+
+const Policy edfPolicy = {
+    .name = "edf",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .init = edfInit,
+    .on_arrival = keyedArrival,
+    .pick_next = keyedPick,
+    .preempts = keyedPreempts,
+    .on_preempt = keyedArrival,
+    .size = keyedSize,
+};
+
+const Policy rmPolicy = {
+    .name = "rm",
+    .modalities = 1 << PREEMPTIVE | 1 << NONPREEMPTIVE,
+    .init = rmInit,
+    .on_arrival = keyedArrival,
+    .pick_next = keyedPick,
+    .preempts = keyedPreempts,
+    .on_preempt = keyedArrival,
+    .size = keyedSize,
+};
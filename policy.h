@@ -0,0 +1,76 @@
+#ifndef _POLICY_H_
+#define _POLICY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "process.h"
+
+struct _simcontext;
+struct _cpu;
+
+// Política de planificació. El motor no coneix cap algorisme: avisa la
+// política quan un procés es fa preparat, li demana el següent de cada CPU
+// i li comunica el que ha executat, les expulsions i les finalitzacions.
+// L'estat privat de la política es guarda a ctx->policy_state; les
+// polítiques predefinides fan servir les cues de cada CPU (fifo, heap,
+// ready).
+typedef struct _policy
+{
+    const char *name;
+    int modalities;     // modalitats admeses: bits 1 << PREEMPTIVE, 1 << NONPREEMPTIVE
+    bool quantum;       // fa servir el quantum de les opcions
+    bool share;         // anota el temps de CPU que correspon a cada procés (Process.entitled)
+
+    // Cicle de vida: init() un cop per context, start() abans de cada
+    // execució (l'arena ja s'ha buidat) i clean() en alliberar el context.
+    // Qualsevol pot ser NULL.
+    int (*init)(struct _simcontext *ctx);
+    int (*start)(struct _simcontext *ctx);
+    void (*clean)(struct _simcontext *ctx);
+
+    // p es fa preparat a la CPU c: arriba o torna de l'E/S. Retorna
+    // EXIT_FAILURE si no hi ha memòria per encolar-lo.
+    int (*on_arrival)(struct _simcontext *ctx, struct _cpu *c, Process *p);
+    // Treu el següent procés de c, o NULL. *slice és el tram màxim que pot
+    // executar abans de tornar a la política (0: fins a acabar la ràfega)
+    Process *(*pick_next)(struct _simcontext *ctx, struct _cpu *c, int *slice);
+    // p ha executat ran unitats a c (pot ser NULL)
+    void (*on_tick)(struct _simcontext *ctx, struct _cpu *c, Process *p, int ran);
+    // El primer preparat de c ha d'expulsar running (NULL: no expulsa mai)
+    bool (*preempts)(struct _simcontext *ctx, struct _cpu *c, Process *running);
+    // p deixa la CPU sense acabar la ràfega, perquè ha esgotat el tram o
+    // l'ha expulsat un altre procés. Ha de tornar a una cua de c; retorna
+    // EXIT_FAILURE si no hi cap.
+    int (*on_preempt)(struct _simcontext *ctx, struct _cpu *c, Process *p);
+    // p ha acabat la ràfega a c i passa a fer E/S (pot ser NULL)
+    void (*on_block)(struct _simcontext *ctx, struct _cpu *c, Process *p);
+    // p ha acabat un treball (pot ser NULL). Si p->completed, la seva
+    // posició de la taula pot tornar a rebre un procés nou (amb un flux):
+    // l'estat per posició ha de tornar al d'abans d'arribar.
+    void (*on_complete)(struct _simcontext *ctx, struct _cpu *c, Process *p);
+    // Processos preparats a c
+    size_t (*size)(struct _simcontext *ctx, struct _cpu *c);
+} Policy;
+
+// Registre de polítiques: l'identificador d'un algorisme és la seva
+// posició. Les predefinides ocupen les posicions de enum algorithms.
+int num_policies(void);
+const Policy *get_policy(int algorithm);
+int find_policy(const char *name);
+const char *algorithm_name(int algorithm);
+bool policy_accepts(const Policy *policy, int modality);
+int policy_modality(const Policy *policy, int modality);
+int policy_weight(const Process *p);
+
+extern const Policy fcfsPolicy;
+extern const Policy sjfPolicy;
+extern const Policy rrPolicy;
+extern const Policy prioritiesPolicy;
+extern const Policy mlfqPolicy;
+extern const Policy cfsPolicy;
+extern const Policy lotteryPolicy;
+extern const Policy stridePolicy;
+extern const Policy edfPolicy;
+extern const Policy rmPolicy;
+
+#endif
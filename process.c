@@ -1,68 +1,118 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include "process.h"
+#include "stats.h"
 
 const char* processStatusNames[] = {"Ready", "Running", "Bloqued","Finished"};
 
 Process initProcess(int id, char* name, int burst, int priority, int arrive_time){
     Process p;
     p.id = id;
-    p.name=strdup(name);
+    p.name=name; // no es copia: el nom és de qui crea la taula
     p.burst=burst;
+    p.bursts=NULL;
+    p.nbursts=1;
+    p.io_time=0;
     p.priority=priority;
     p.arrive_time=arrive_time;
+    p.deadline=0;
+    p.period=0;
+    p.executed=0;
+    p.remaining=burst;
+    p.current=0;
+    p.wakeup=0;
+    p.entitled=0;
+    p.release=arrive_time;
+    p.enqueued=arrive_time;
+    p.max_wait=0;
+    p.jobs=0;
+    p.lifecycle=NULL;
+    p.lifecycle_size=0;
+    p.lifecycle_capacity=0;
     return p;
 }
 
-Process initProcessFromTokens(char* line, char* separator){
-
-  const size_t BUFSIZE = 32;   
-  size_t bufsize = BUFSIZE;
-  Process p;
-
-  char *feature = malloc(bufsize * sizeof(char));
-  feature=strtok(line, separator); 
-
-  int features = 0;
-  while (feature != NULL) {
-            switch (features)
-            {
-            case 0:
-                p.id=atoi(feature);
-                break;
-            case 1:
-                p.name=malloc(sizeof(feature));
-                strcpy(p.name,feature);
-                break;
-            case 2:
-                p.priority=atoi(feature);
-                break;
-            case 3:
-                p.arrive_time=atoi(feature);
-                break;
-            case 4:
-                p.burst=atoi(feature);
-            }
-            feature=strtok(NULL, ";"); 
-            features++;
+// Assigna la seqüència de ràfegues (no es copia) i en recalcula els
+// totals de CPU i d'E/S. Una seqüència vàlida té un nombre senar de
+// ràfegues, les de CPU positives i les d'E/S no negatives.
+int setBursts(Process* p, const int* bursts, int nbursts){
+    if (nbursts < 1 || nbursts % 2 == 0){
+        return EXIT_FAILURE;
+    }
+    long cpu = 0;
+    long io = 0;
+    for (int k = 0; k < nbursts; k++){
+        if (k % 2 == 0 ? bursts[k] <= 0 : bursts[k] < 0){
+            return EXIT_FAILURE;
+        }
+        if (k % 2 == 0){
+            cpu += bursts[k];
+        }else{
+            io += bursts[k];
+        }
+    }
+    if (cpu > INT_MAX || io > INT_MAX){
+        return EXIT_FAILURE;
     }
-  free(feature);
-  return p;
+    p->bursts = nbursts > 1 ? bursts : NULL;
+    p->nbursts = nbursts;
+    p->burst = (int)cpu;
+    p->io_time = (int)io;
+    p->remaining = bursts[0];
+    return EXIT_SUCCESS;
 }
 
-void destroyProcess(Process p){
-
-    if (p.name != NULL){
-        free(p.name);
-    }
+// Durada de la ràfega k (les parells són de CPU i les senars d'E/S)
+int getBurst(const Process* p, int k){
+    return p->bursts != NULL ? p->bursts[k] : p->burst;
+}
 
-    if (p.lifecycle != NULL){
+// Allibera la història de p. La que s'ha reservat a una arena (la del
+// motor) no s'allibera aquí, sinó amb l'arena sencera.
+void destroyProcess(Process p, Arena* arena){
+    if (arena == NULL && p.lifecycle != NULL){
         free(p.lifecycle);
     }
 };
 
 
+// Afegeix el tram [start, end) a la història. Si continua l'últim tram
+// amb el mateix estat i a la mateixa CPU, l'allarga en lloc de crear-ne un de nou.
+// Amb arena, la història es reserva a l'arena; sense, es fa amb realloc.
+// destroyProcess() s'ha de cridar amb la mateixa arena.
+int addSegment(Process* p, Arena* arena, int start, int end, int state, int cpu){
+    if (end <= start){
+        return EXIT_SUCCESS;
+    }
+    if (p->lifecycle_size > 0){
+        Segment* last = &p->lifecycle[p->lifecycle_size - 1];
+        if (last->end == start && last->state == state && last->cpu == cpu){
+            last->end = end;
+            return EXIT_SUCCESS;
+        }
+    }
+    if (p->lifecycle_size == p->lifecycle_capacity){
+        size_t capacity = p->lifecycle_capacity > 0 ? 2 * p->lifecycle_capacity : 4;
+        if (arena == NULL){
+            STATS_INC(STAT_MALLOCS);
+        }
+        Segment* lifecycle = arena != NULL
+            ? arena_grow(arena, p->lifecycle, p->lifecycle_capacity * sizeof(Segment), capacity * sizeof(Segment))
+            : realloc(p->lifecycle, capacity * sizeof(Segment));
+        if (lifecycle == NULL){
+            return EXIT_FAILURE;
+        }
+        p->lifecycle = lifecycle;
+        p->lifecycle_capacity = capacity;
+    }
+    Segment segment = {start, end, state, cpu};
+    p->lifecycle[p->lifecycle_size++] = segment;
+    STATS_INC(STAT_SEGMENTS);
+    return EXIT_SUCCESS;
+}
+
 void printProcess(Process proces){
     printf("{id:%d, name:%s, priority:%d, arrive_time:%d, burst:%d}\n", proces.id,proces.name,proces.priority,proces.arrive_time,proces.burst);
 }
@@ -78,6 +128,47 @@ int compareArrival(const void *s1, const void *s2){
         return 0;
 }
 
+// Ordena la taula per arribada de manera estable: els processos que
+// arriben alhora mantenen l'ordre del fitxer. Una taula que ja és en ordre
+// (la del generador o la d'una simulació anterior) només es recorre.
+int sortByArrival(Process* table, size_t n){
+    size_t i = 1;
+    while (i < n && table[i - 1].arrive_time <= table[i].arrive_time){
+        i++;
+    }
+    if (i >= n){
+        return EXIT_SUCCESS;
+    }
+    Process *tmp = malloc(n * sizeof(Process));
+    if (tmp == NULL){
+        return EXIT_FAILURE;
+    }
+    // Fusió de baix a dalt alternant entre table i tmp
+    Process *from = table;
+    Process *to = tmp;
+    for (size_t width = 1; width < n; width *= 2){
+        for (size_t lo = 0; lo < n; lo += 2 * width){
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = mid + width < n ? mid + width : n;
+            size_t a = lo, b = mid, k = lo;
+            while (a < mid && b < hi){
+                to[k++] = from[b].arrive_time < from[a].arrive_time ? from[b++] : from[a++];
+            }
+            memcpy(&to[k], &from[a], (mid - a) * sizeof(Process));
+            k += mid - a;
+            memcpy(&to[k], &from[b], (hi - b) * sizeof(Process));
+        }
+        Process *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != table){
+        memcpy(table, from, n * sizeof(Process));
+    }
+    free(tmp);
+    return EXIT_SUCCESS;
+}
+
 int compareBurst(const void *s1, const void *s2){
     Process *p1 = (Process *)s1;
     Process *p2 = (Process *)s2;
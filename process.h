@@ -2,6 +2,8 @@
 #define __PROCESS__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
 
 // Process
 // Ready: The process is in the queue waiting for the scheduler.
@@ -12,29 +14,57 @@ enum processStatus{Ready, Running, Bloqued, Finished};
 
 
 
+// Tram de la història d'un procés: [start, end) en l'estat state
+typedef struct _segment
+{
+    int start;
+    int end;
+    int state;
+    int cpu;
+} Segment;
+
 typedef struct _process
 {
     // Information required by the scheduler
     int id;
     char* name;
-    int burst; // [[2,Running],[],[burst,operation]] 
+    int burst;                 // temps total de CPU (suma de les ràfegues de CPU)
+    const int* bursts;         // ràfegues alternades CPU, E/S, CPU...; NULL: una sola ràfega de CPU
+    int nbursts;               // sempre senar: es comença i s'acaba amb CPU
+    int io_time;               // temps total d'E/S
     int priority;
     int arrive_time;           
+    int deadline;              // termini relatiu a cada alliberament; 0: sense termini
+    int period;                // tasca periòdica: un treball cada period; 0: aperiòdica
     // Information obtained during and after the life of the process
-    int* lifecycle;     
+    Segment* lifecycle;       //Trams d'execució, ordenats per temps
+    size_t lifecycle_size;
+    size_t lifecycle_capacity;
+    int executed;      //Temps de CPU consumit
+    int remaining;     //Temps de CPU pendent de la ràfega en curs
+    int current;       //Ràfega en curs (índex a bursts)
+    int wakeup;        //Instant en què acaba l'E/S en curs
     int waiting_time;  //Temps espera    
     int return_time;   //Temps de retorn      
     int response_time; //Temps de resposta
+    double entitled;   //Temps de CPU que li corresponia (polítiques proporcionals; 0: cap)
+    int release;       //Alliberament del treball en curs (arrive_time si és aperiòdica)
+    int enqueued;      //Instant de l'última entrada a una cua de preparats
+    int max_wait;      //Espera més llarga d'una sola vegada a la cua (treball en curs)
+    int jobs;          //Treballs acabats (tasques periòdiques)
     bool completed;         
 } Process;
 
 Process initProcess(int id, char* name, int burst, int priority, int arrive_time);
-Process initProcessFromTokens(char* line, char* separator);
-void destroyProcess(Process p);
+int setBursts(Process* p, const int* bursts, int nbursts);
+int getBurst(const Process* p, int k);
+void destroyProcess(Process p, Arena* arena);
 void printProcess(Process proces);
 int compareArrival(const void *s1, const void *s2);
+int sortByArrival(Process* table, size_t n);
 int compareBurst(const void *s1, const void *s2);
 int comparePriority(const void *s1, const void *s2);
 void printLife(Process* p, int t);
+int addSegment(Process* p, Arena* arena, int start, int end, int state, int cpu);
 
 #endif
\ No newline at end of file
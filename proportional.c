@@ -0,0 +1,443 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+#include "policy.h"
+#include "fenwick.h"
+#include "rbtree.h"
+#include "generator.h"
+
+// Planificació proporcional: cada procés té tants tiquets com el seu pes
+// (policy_weight()) i, a cada quantum, la CPU es dona a un dels preparats.
+// La loteria sorteja el guanyador amb probabilitat proporcional als
+// tiquets; stride dona la CPU al que té la passa més petita i l'avança en
+// inversa als tiquets, de manera que el repartiment és el mateix però
+// determinista.
+//
+// Totes dues anoten el temps de CPU que correspondria a cada procés
+// (Process.entitled): mentre és executable (preparat o en execució) a
+// una CPU, li toca la fracció tiquets / tiquets executables de la CPU.
+// Per no recórrer els processos a cada canvi, cada CPU acumula el temps
+// per tiquet (vtime) i un procés en surt amb tiquets * (vtime de sortida
+// - vtime d'entrada).
+#define STRIDE1 (1LL << 20)
+
+typedef struct _shareaccount
+{
+    double *vtime;          // per CPU: integral de dt / tiquets executables
+    long long *tickets;     // per CPU: tiquets dels processos executables
+    int *last;              // per CPU: instant fins al qual s'ha integrat vtime
+    double *enter;          // per procés: vtime de la CPU en entrar-hi
+    int *home;              // per procés: CPU on és executable, o -1
+} ShareAccount;
+
+typedef struct _proportional
+{
+    ShareAccount share;
+    // Loteria: tiquets dels preparats de cada CPU, per posició a la taula
+    Fenwick *fenwicks;
+    size_t *sizes;
+    uint64_t rng;
+    // Stride: preparats de cada CPU per passa, com el temps virtual de CFS
+    RBNode *nodes;
+    RBTree *trees;
+    long long *pass;        // per procés
+    long long *global;      // per CPU: passa mínima, monòtona
+    int *passHome;          // CPU a la qual es refereix pass, o -1
+} Proportional;
+
+static int shareInit(ShareAccount *sa, size_t ncpus, size_t nprocs)
+{
+    sa->vtime = calloc(ncpus, sizeof(double));
+    sa->tickets = calloc(ncpus, sizeof(long long));
+    sa->last = calloc(ncpus, sizeof(int));
+    sa->enter = calloc(nprocs, sizeof(double));
+    sa->home = calloc(nprocs, sizeof(int));
+    return sa->vtime != NULL && sa->tickets != NULL && sa->last != NULL && sa->enter != NULL && sa->home != NULL
+               ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void shareStart(ShareAccount *sa, size_t ncpus, size_t nprocs)
+{
+    memset(sa->vtime, 0, ncpus * sizeof(double));
+    memset(sa->tickets, 0, ncpus * sizeof(long long));
+    memset(sa->last, 0, ncpus * sizeof(int));
+    for (size_t p = 0; p < nprocs; p++)
+    {
+        sa->home[p] = -1;
+    }
+}
+
+static void shareClean(ShareAccount *sa)
+{
+    free(sa->vtime);
+    free(sa->tickets);
+    free(sa->last);
+    free(sa->enter);
+    free(sa->home);
+}
+
+// Integra vtime de la CPU fins a l'instant actual
+static void shareAdvance(SimContext *ctx, ShareAccount *sa, int cpu)
+{
+    int t = ctx->clock;
+    if (sa->tickets[cpu] > 0 && t > sa->last[cpu])
+    {
+        sa->vtime[cpu] += (double)(t - sa->last[cpu]) / (double)sa->tickets[cpu];
+    }
+    sa->last[cpu] = t;
+}
+
+static void shareJoin(SimContext *ctx, ShareAccount *sa, int cpu, Process *p)
+{
+    size_t order = (size_t)(p - ctx->procTable);
+    shareAdvance(ctx, sa, cpu);
+    sa->tickets[cpu] += policy_weight(p);
+    sa->enter[order] = sa->vtime[cpu];
+    sa->home[order] = cpu;
+}
+
+static void shareLeave(SimContext *ctx, ShareAccount *sa, Process *p)
+{
+    size_t order = (size_t)(p - ctx->procTable);
+    int cpu = sa->home[order];
+    if (cpu < 0)
+    {
+        return;
+    }
+    shareAdvance(ctx, sa, cpu);
+    p->entitled += policy_weight(p) * (sa->vtime[cpu] - sa->enter[order]);
+    sa->tickets[cpu] -= policy_weight(p);
+    sa->home[order] = -1;
+}
+
+// Un procés robat passa a competir a la CPU que l'executa
+static void shareMove(SimContext *ctx, ShareAccount *sa, int cpu, Process *p)
+{
+    if (sa->home[p - ctx->procTable] != cpu)
+    {
+        shareLeave(ctx, sa, p);
+        shareJoin(ctx, sa, cpu, p);
+    }
+}
+
+static void proportionalClean(SimContext *ctx)
+{
+    Proportional *ps = ctx->policy_state;
+    if (ps == NULL)
+    {
+        return;
+    }
+    shareClean(&ps->share);
+    for (int c = 0; ps->fenwicks != NULL && c < ctx->ncpus; c++)
+    {
+        clean_fenwick(&ps->fenwicks[c]);
+    }
+    free(ps->fenwicks);
+    free(ps->sizes);
+    free(ps->nodes);
+    free(ps->trees);
+    free(ps->pass);
+    free(ps->global);
+    free(ps->passHome);
+    free(ps);
+    ctx->policy_state = NULL;
+}
+
+static Proportional *proportionalInit(SimContext *ctx)
+{
+    Proportional *ps = calloc(1, sizeof(Proportional));
+    ctx->policy_state = ps;
+    size_t nprocs = ctx->nprocs > 0 ? ctx->nprocs : 1;
+    if (ps == NULL || shareInit(&ps->share, (size_t)ctx->ncpus, nprocs) != EXIT_SUCCESS)
+    {
+        return NULL;
+    }
+    return ps;
+}
+
+static void shareBlock(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    shareLeave(ctx, &ps->share, p);
+}
+
+static void shareTick(SimContext *ctx, CPU *c, Process *p, int ran)
+{
+    Proportional *ps = ctx->policy_state;
+    shareMove(ctx, &ps->share, c->id, p);
+}
+
+// Loteria: un arbre de Fenwick per CPU amb els tiquets dels preparats.
+// Sortejar és triar un tiquet a l'atzar i buscar-ne el propietari.
+static int lotteryInit(SimContext *ctx)
+{
+    Proportional *ps = proportionalInit(ctx);
+    if (ps == NULL)
+    {
+        proportionalClean(ctx);
+        return EXIT_FAILURE;
+    }
+    ps->fenwicks = calloc((size_t)ctx->ncpus, sizeof(Fenwick));
+    ps->sizes = calloc((size_t)ctx->ncpus, sizeof(size_t));
+    for (int c = 0; ps->fenwicks != NULL && c < ctx->ncpus; c++)
+    {
+        if (init_fenwick(&ps->fenwicks[c], ctx->nprocs) != EXIT_SUCCESS)
+        {
+            proportionalClean(ctx);
+            return EXIT_FAILURE;
+        }
+    }
+    if (ps->fenwicks == NULL || ps->sizes == NULL)
+    {
+        proportionalClean(ctx);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Cada execució torna a començar la seqüència aleatòria des de la llavor
+static int lotteryStart(SimContext *ctx)
+{
+    Proportional *ps = ctx->policy_state;
+    shareStart(&ps->share, (size_t)ctx->ncpus, ctx->nprocs);
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        reset_fenwick(&ps->fenwicks[c]);
+        ps->sizes[c] = 0;
+    }
+    uint64_t seed = ctx->options.seed != 0 ? ctx->options.seed : 1;
+    ps->rng = seed * 0x9E3779B97F4A7C15ULL;
+    ps->rng = ps->rng != 0 ? ps->rng : 1;
+    return EXIT_SUCCESS;
+}
+
+static void lotteryEnqueue(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    fenwick_add(&ps->fenwicks[c->id], (size_t)(p - ctx->procTable), policy_weight(p));
+    ps->sizes[c->id]++;
+}
+
+static int lotteryArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    shareJoin(ctx, &ps->share, c->id, p);
+    lotteryEnqueue(ctx, c, p);
+    return EXIT_SUCCESS;
+}
+
+static int lotteryPreempt(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    shareMove(ctx, &ps->share, c->id, p);
+    lotteryEnqueue(ctx, c, p);
+    return EXIT_SUCCESS;
+}
+
+// Tiquet uniforme a [0, total) amb la multiplicació de Lemire: la part alta
+// de random * total, rebutjant els pocs valors que farien el repartiment
+// desigual. El mòdul afavoriria els tiquets baixos quan total no divideix 2^64.
+static uint64_t drawTicket(uint64_t *rng, uint64_t total)
+{
+    unsigned __int128 m = (unsigned __int128)nextRandom(rng) * total;
+    if ((uint64_t)m < total)
+    {
+        uint64_t threshold = -total % total;
+        while ((uint64_t)m < threshold)
+        {
+            m = (unsigned __int128)nextRandom(rng) * total;
+        }
+    }
+    return (uint64_t)(m >> 64);
+}
+
+static Process *lotteryPick(SimContext *ctx, CPU *c, int *slice)
+{
+    Proportional *ps = ctx->policy_state;
+    Fenwick *f = &ps->fenwicks[c->id];
+    if (ps->sizes[c->id] == 0)
+    {
+        return NULL;
+    }
+    long long ticket = (long long)drawTicket(&ps->rng, (uint64_t)fenwick_total(f));
+    size_t order = fenwick_find(f, ticket);
+    Process *p = &ctx->procTable[order];
+    fenwick_add(f, order, -policy_weight(p));
+    ps->sizes[c->id]--;
+    *slice = ctx->options.quantum;
+    return p;
+}
+
+static size_t lotterySize(SimContext *ctx, CPU *c)
+{
+    Proportional *ps = ctx->policy_state;
+    return ps->sizes[c->id];
+}
+
+// Stride: la passa avança STRIDE1 / tiquets per unitat executada. Un
+// procés nou o que torna de l'E/S no pot quedar per sota de la passa
+// mínima de la CPU; un de robat conserva la distància a la mínima.
+static int strideInit(SimContext *ctx)
+{
+    Proportional *ps = proportionalInit(ctx);
+    if (ps == NULL)
+    {
+        proportionalClean(ctx);
+        return EXIT_FAILURE;
+    }
+    size_t nprocs = ctx->nprocs > 0 ? ctx->nprocs : 1;
+    ps->nodes = init_rbtree_nodes(ctx->nprocs);
+    ps->trees = calloc((size_t)ctx->ncpus, sizeof(RBTree));
+    ps->pass = calloc(nprocs, sizeof(long long));
+    ps->global = calloc((size_t)ctx->ncpus, sizeof(long long));
+    ps->passHome = calloc(nprocs, sizeof(int));
+    if (ps->nodes == NULL || ps->trees == NULL || ps->pass == NULL || ps->global == NULL || ps->passHome == NULL)
+    {
+        proportionalClean(ctx);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int strideStart(SimContext *ctx)
+{
+    Proportional *ps = ctx->policy_state;
+    shareStart(&ps->share, (size_t)ctx->ncpus, ctx->nprocs);
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        init_rbtree(&ps->trees[c], ps->nodes, ctx->nprocs);
+        ps->global[c] = 0;
+    }
+    for (size_t p = 0; p < ctx->nprocs; p++)
+    {
+        ps->pass[p] = 0;
+        ps->passHome[p] = -1;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void strideMigrate(Proportional *ps, size_t order, int cpu)
+{
+    if (ps->passHome[order] >= 0 && ps->passHome[order] != cpu)
+    {
+        ps->pass[order] += ps->global[cpu] - ps->global[ps->passHome[order]];
+    }
+    ps->passHome[order] = cpu;
+}
+
+static void strideUpdateGlobal(Proportional *ps, CPU *c, long long current)
+{
+    RBTree *tree = &ps->trees[c->id];
+    size_t first = rbtree_first(tree);
+    if (first != RB_NONE && rbtree_key(tree, first) < current)
+    {
+        current = rbtree_key(tree, first);
+    }
+    if (current > ps->global[c->id])
+    {
+        ps->global[c->id] = current;
+    }
+}
+
+static int strideArrival(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    shareJoin(ctx, &ps->share, c->id, p);
+    strideMigrate(ps, order, c->id);
+    if (ps->pass[order] < ps->global[c->id])
+    {
+        ps->pass[order] = ps->global[c->id];
+    }
+    rbtree_insert(&ps->trees[c->id], order, ps->pass[order]);
+    return EXIT_SUCCESS;
+}
+
+static int stridePreempt(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    shareMove(ctx, &ps->share, c->id, p);
+    strideMigrate(ps, order, c->id);
+    rbtree_insert(&ps->trees[c->id], order, ps->pass[order]);
+    return EXIT_SUCCESS;
+}
+
+static Process *stridePick(SimContext *ctx, CPU *c, int *slice)
+{
+    Proportional *ps = ctx->policy_state;
+    RBTree *tree = &ps->trees[c->id];
+    size_t order = rbtree_first(tree);
+    if (order == RB_NONE)
+    {
+        return NULL;
+    }
+    rbtree_remove(tree, order);
+    strideUpdateGlobal(ps, c, ps->pass[order]);
+    *slice = ctx->options.quantum;
+    return &ctx->procTable[order];
+}
+
+static void strideTick(SimContext *ctx, CPU *c, Process *p, int ran)
+{
+    Proportional *ps = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    shareMove(ctx, &ps->share, c->id, p);
+    strideMigrate(ps, order, c->id);
+    ps->pass[order] += ran * (STRIDE1 / policy_weight(p));
+    strideUpdateGlobal(ps, c, ps->pass[order]);
+}
+
+// Un procés que acaba del tot deixa la posició com si no hagués arribat
+static void strideComplete(SimContext *ctx, CPU *c, Process *p)
+{
+    Proportional *ps = ctx->policy_state;
+    size_t order = (size_t)(p - ctx->procTable);
+    shareBlock(ctx, c, p);
+    if (p->completed)
+    {
+        ps->pass[order] = 0;
+        ps->passHome[order] = -1;
+    }
+}
+
+static size_t strideSize(SimContext *ctx, CPU *c)
+{
+    Proportional *ps = ctx->policy_state;
+    return rbtree_size(&ps->trees[c->id]);
+}
+
+const Policy lotteryPolicy = {
+    .name = "lottery",
+    .modalities = 1 << PREEMPTIVE,
+    .quantum = true,
+    .share = true,
+    .init = lotteryInit,
+    .start = lotteryStart,
+    .clean = proportionalClean,
+    .on_arrival = lotteryArrival,
+    .pick_next = lotteryPick,
+    .on_tick = shareTick,
+    .on_preempt = lotteryPreempt,
+    .on_block = shareBlock,
+    .on_complete = shareBlock,
+    .size = lotterySize,
+};
+
+const Policy stridePolicy = {
+    .name = "stride",
+    .modalities = 1 << PREEMPTIVE,
+    .quantum = true,
+    .share = true,
+    .init = strideInit,
+    .start = strideStart,
+    .clean = proportionalClean,
+    .on_arrival = strideArrival,
+    .pick_next = stridePick,
+    .on_tick = strideTick,
+    .on_preempt = stridePreempt,
+    .on_block = shareBlock,
+    .on_complete = strideComplete,
+    .size = strideSize,
+};
@@ -2,87 +2,145 @@
 #include <stdlib.h>
 #include "queue.h"
 #include "process.h"
+#include "stats.h"
 #include <string.h>
 
-Process** queue;
-size_t elements;
+// Cua circular: la capacitat és sempre potència de 2 i les posicions es
+// calculen amb (front + i) & (capacity - 1). Ni enqueue ni dequeue
+// desplacen elements, i només es fa realloc quan la cua és plena.
+#define QUEUE_MIN_CAPACITY 16
 
-void init_queue(){
-    queue = malloc(1 * sizeof(Process*));
-    elements = 0;
+#define QUEUE_AT(q, i) (q)->items[((q)->front + (i)) & ((q)->capacity - 1)]
+
+static Process** alloc_items(Queue* q, size_t capacity){
+    if (q->arena == NULL){
+        STATS_INC(STAT_MALLOCS);
+    }
+    return q->arena != NULL ? arena_alloc(q->arena, capacity * sizeof(Process*)) : malloc(capacity * sizeof(Process*));
 }
 
-size_t get_queue_size(){
-    return elements;
+int init_queue(Queue* q){
+    return init_queue_arena(q, NULL);
 }
 
-int enqueue(Process* process){
-    if (queue != NULL){
-        queue[elements] = process;
-        elements++;
-        queue = realloc(queue,(elements+1)*sizeof(Process*));
-        queue[elements]=NULL;
+int init_queue_arena(Queue* q, Arena* arena){
+    q->arena = arena;
+    q->items = alloc_items(q, QUEUE_MIN_CAPACITY);
+    q->capacity = q->items != NULL ? QUEUE_MIN_CAPACITY : 0;
+    q->elements = 0;
+    q->front = 0;
+    return q->items != NULL ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+size_t get_queue_size(Queue* q){
+    return q->elements;
+}
+
+int reserve_queue(Queue* q, size_t size){
+    if (q->items == NULL){
+        return EXIT_FAILURE;
+    }
+    if (size <= q->capacity){
         return EXIT_SUCCESS;
-    } else {
+    }
+    size_t new_capacity = q->capacity;
+    while (new_capacity < size){
+        new_capacity <<= 1;
+    }
+    Process** items = alloc_items(q, new_capacity);
+    if (items == NULL){
         return EXIT_FAILURE;
     }
+    STATS_INC(STAT_QUEUE_GROWS);
+    // Es copia en ordre, de manera que el front torna a la posició 0
+    for (size_t i = 0; i < q->elements; i++){
+        items[i] = QUEUE_AT(q, i);
+    }
+    if (q->arena == NULL){
+        free(q->items);
+    }
+    q->items = items;
+    q->capacity = new_capacity;
+    q->front = 0;
+    return EXIT_SUCCESS;
 }
 
-Process* dequeue(){
-    if (elements <= 0){
+int enqueue(Queue* q, Process* process){
+    if (q->items == NULL){
+        return EXIT_FAILURE;
+    }
+    if (q->elements == q->capacity && reserve_queue(q, q->capacity << 1) != EXIT_SUCCESS){
+        return EXIT_FAILURE;
+    }
+    QUEUE_AT(q, q->elements) = process;
+    q->elements++;
+    STATS_INC(STAT_ENQUEUES);
+    return EXIT_SUCCESS;
+}
+
+Process* dequeue(Queue* q){
+    if (q->elements <= 0){
         return NULL;
-    } else {
-        Process* process = queue[0];
-        elements--;
-        queue = realloc(queue,(elements+1)*sizeof(Process));
-        for(int p=1; p<=elements; p++){
-            queue[p-1]=queue[p];
-        }
-        return process;
     }
+    Process* process = q->items[q->front];
+    q->front = (q->front + 1) & (q->capacity - 1);
+    q->elements--;
+    STATS_INC(STAT_DEQUEUES);
+    return process;
+}
+
+Process* peek_queue(Queue* q){
+    return q->elements > 0 ? q->items[q->front] : NULL;
 }
 
-void cleanQueue(){
-    free(queue);
+void cleanQueue(Queue* q){
+    if (q->arena == NULL){
+        free(q->items);
+    }
+    q->items = NULL;
+    q->capacity = 0;
+    q->elements = 0;
+    q->front = 0;
 }
 
-char* queueToString(){
-    char* queue_str = malloc( sizeof(char) * strlen("Front->[")+1);
-    strcpy(queue_str,"Front->[");
-    if (queue != NULL && elements>=1){
-        for(int i=0; i<elements-1; i++){
-            Process p = *queue[i];
-            queue_str = realloc(queue_str, sizeof(char) * (strlen(queue_str) + strlen(p.name) + 2) );
-            strcat(queue_str,p.name);
-            strcat(queue_str,",");
+// Es mesura primer la cadena sencera i s'omple amb una sola reserva
+char* queueToString(Queue* q){
+    static const char front[] = "Front->[";
+    static const char rear[] = "]<-Rear";
+    size_t elements = q->items != NULL ? q->elements : 0;
+    size_t length = strlen(front) + strlen(rear) + (elements > 0 ? elements - 1 : 0);
+    for (size_t i = 0; i < elements; i++){
+        length += strlen(QUEUE_AT(q, i)->name);
+    }
+    char* queue_str = malloc(length + 1);
+    if (queue_str == NULL){
+        return NULL;
+    }
+    char* s = queue_str;
+    memcpy(s, front, strlen(front));
+    s += strlen(front);
+    for (size_t i = 0; i < elements; i++){
+        if (i > 0){
+            *s++ = ',';
         }
-        Process p = *queue[elements-1];
-        queue_str = realloc(queue_str,sizeof(char) * (strlen(queue_str)+strlen(p.name)+1) );
-        strcat(queue_str,p.name);   
+        size_t len = strlen(QUEUE_AT(q, i)->name);
+        memcpy(s, QUEUE_AT(q, i)->name, len);
+        s += len;
     }
-    queue_str = realloc(queue_str,sizeof(char) * (strlen(queue_str)+strlen("]<-Rear")+1) );
-    strcat(queue_str,"]<-Rear");
+    memcpy(s, rear, strlen(rear) + 1);
     return queue_str;
 }
 
-Process* transformQueueToList(){
-    Process* _list = malloc(sizeof(elements-1)*sizeof(Process));
-    for (int i=0; i<elements; i++){
-        _list[i]=*queue[i];
+Process* transformQueueToList(Queue* q){
+    Process* _list = malloc(q->elements * sizeof(Process));
+    for (size_t i=0; i<q->elements; i++){
+        _list[i]=*QUEUE_AT(q, i);
     }
     return _list;
 }
 
-void setQueueFromList(Process* list){
-    for (int i=0; i<elements; i++){
-        *(queue[i])=list[i];
+void setQueueFromList(Queue* q, Process* list){
+    for (size_t i=0; i<q->elements; i++){
+        *(QUEUE_AT(q, i))=list[i];
     }
 }
-
-
-
-
-
-
-
-
@@ -1,19 +1,36 @@
 #ifndef _QUEUE_H_
 #define _QUEUE_H_
 
+#include <stddef.h>
 #include "process.h"
+#include "arena.h"
 
 
 # define EMPTY -1
 # define NOT_INIT 0
 
-void init_queue(void);
-int enqueue(Process* item);
-Process* dequeue(void);
-size_t get_queue_size(void);
-void cleanQueue(void);
-char* queueToString(void);
-Process* transformQueueToList(void);
-void setQueueFromList(Process* list);
+// Cua FIFO de processos sobre un buffer circular. Amb arena, el buffer
+// és de l'arena i no s'allibera per separat.
+typedef struct _queue
+{
+    Process** items;
+    size_t elements;
+    size_t capacity;
+    size_t front;
+    Arena* arena;
+} Queue;
 
-#endif
\ No newline at end of file
+// Totes les operacions reben la cua explícitament: no hi ha cap cua global
+int init_queue(Queue* q);
+int init_queue_arena(Queue* q, Arena* arena);
+int reserve_queue(Queue* q, size_t size);
+int enqueue(Queue* q, Process* process);
+Process* dequeue(Queue* q);
+Process* peek_queue(Queue* q);
+size_t get_queue_size(Queue* q);
+void cleanQueue(Queue* q);
+char* queueToString(Queue* q);
+Process* transformQueueToList(Queue* q);
+void setQueueFromList(Queue* q, Process* list);
+
+#endif
@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include "rbtree.h"
+
+#define NODE(t, i) (&(t)->nodes[i])
+
+// Vector de nodes per a nprocs processos més la sentinella, que és negra
+RBNode* init_rbtree_nodes(size_t nprocs){
+    RBNode* nodes = calloc(nprocs + 1, sizeof(RBNode));
+    if (nodes != NULL){
+        nodes[nprocs].red = false;
+    }
+    return nodes;
+}
+
+void init_rbtree(RBTree* t, RBNode* nodes, size_t nprocs){
+    t->nodes = nodes;
+    t->nil = nprocs;
+    t->root = nprocs;
+    t->leftmost = RB_NONE;
+    t->size = 0;
+}
+
+// a va abans que b: clau menor i, en cas d'empat, posició anterior
+static bool rb_less(RBTree* t, size_t a, size_t b){
+    long long ka = NODE(t, a)->key, kb = NODE(t, b)->key;
+    return ka < kb || (ka == kb && a < b);
+}
+
+static void rotate_left(RBTree* t, size_t x){
+    size_t y = NODE(t, x)->right;
+    NODE(t, x)->right = NODE(t, y)->left;
+    if (NODE(t, y)->left != t->nil){
+        NODE(t, NODE(t, y)->left)->parent = x;
+    }
+    size_t parent = NODE(t, x)->parent;
+    NODE(t, y)->parent = parent;
+    if (parent == t->nil){
+        t->root = y;
+    }else if (x == NODE(t, parent)->left){
+        NODE(t, parent)->left = y;
+    }else{
+        NODE(t, parent)->right = y;
+    }
+    NODE(t, y)->left = x;
+    NODE(t, x)->parent = y;
+}
+
+static void rotate_right(RBTree* t, size_t x){
+    size_t y = NODE(t, x)->left;
+    NODE(t, x)->left = NODE(t, y)->right;
+    if (NODE(t, y)->right != t->nil){
+        NODE(t, NODE(t, y)->right)->parent = x;
+    }
+    size_t parent = NODE(t, x)->parent;
+    NODE(t, y)->parent = parent;
+    if (parent == t->nil){
+        t->root = y;
+    }else if (x == NODE(t, parent)->right){
+        NODE(t, parent)->right = y;
+    }else{
+        NODE(t, parent)->left = y;
+    }
+    NODE(t, y)->right = x;
+    NODE(t, x)->parent = y;
+}
+
+static void insert_fixup(RBTree* t, size_t z){
+    while (NODE(t, NODE(t, z)->parent)->red){
+        size_t parent = NODE(t, z)->parent;
+        size_t grand = NODE(t, parent)->parent;
+        if (parent == NODE(t, grand)->left){
+            size_t uncle = NODE(t, grand)->right;
+            if (NODE(t, uncle)->red){
+                NODE(t, parent)->red = false;
+                NODE(t, uncle)->red = false;
+                NODE(t, grand)->red = true;
+                z = grand;
+                continue;
+            }
+            if (z == NODE(t, parent)->right){
+                z = parent;
+                rotate_left(t, z);
+                parent = NODE(t, z)->parent;
+            }
+            NODE(t, parent)->red = false;
+            NODE(t, grand)->red = true;
+            rotate_right(t, grand);
+        }else{
+            size_t uncle = NODE(t, grand)->left;
+            if (NODE(t, uncle)->red){
+                NODE(t, parent)->red = false;
+                NODE(t, uncle)->red = false;
+                NODE(t, grand)->red = true;
+                z = grand;
+                continue;
+            }
+            if (z == NODE(t, parent)->left){
+                z = parent;
+                rotate_right(t, z);
+                parent = NODE(t, z)->parent;
+            }
+            NODE(t, parent)->red = false;
+            NODE(t, grand)->red = true;
+            rotate_left(t, grand);
+        }
+    }
+    NODE(t, t->root)->red = false;
+}
+
+void rbtree_insert(RBTree* t, size_t order, long long key){
+    RBNode* z = NODE(t, order);
+    z->key = key;
+    z->left = t->nil;
+    z->right = t->nil;
+    z->red = true;
+    size_t parent = t->nil;
+    size_t x = t->root;
+    while (x != t->nil){
+        parent = x;
+        x = rb_less(t, order, x) ? NODE(t, x)->left : NODE(t, x)->right;
+    }
+    z->parent = parent;
+    if (parent == t->nil){
+        t->root = order;
+    }else if (rb_less(t, order, parent)){
+        NODE(t, parent)->left = order;
+    }else{
+        NODE(t, parent)->right = order;
+    }
+    if (t->leftmost == RB_NONE || rb_less(t, order, t->leftmost)){
+        t->leftmost = order;
+    }
+    t->size++;
+    insert_fixup(t, order);
+}
+
+static size_t minimum(RBTree* t, size_t x){
+    while (NODE(t, x)->left != t->nil){
+        x = NODE(t, x)->left;
+    }
+    return x;
+}
+
+// v ocupa el lloc de u (v pot ser la sentinella)
+static void transplant(RBTree* t, size_t u, size_t v){
+    size_t parent = NODE(t, u)->parent;
+    if (parent == t->nil){
+        t->root = v;
+    }else if (u == NODE(t, parent)->left){
+        NODE(t, parent)->left = v;
+    }else{
+        NODE(t, parent)->right = v;
+    }
+    NODE(t, v)->parent = parent;
+}
+
+static void remove_fixup(RBTree* t, size_t x){
+    while (x != t->root && !NODE(t, x)->red){
+        size_t parent = NODE(t, x)->parent;
+        if (x == NODE(t, parent)->left){
+            size_t w = NODE(t, parent)->right;
+            if (NODE(t, w)->red){
+                NODE(t, w)->red = false;
+                NODE(t, parent)->red = true;
+                rotate_left(t, parent);
+                w = NODE(t, parent)->right;
+            }
+            if (!NODE(t, NODE(t, w)->left)->red && !NODE(t, NODE(t, w)->right)->red){
+                NODE(t, w)->red = true;
+                x = parent;
+                continue;
+            }
+            if (!NODE(t, NODE(t, w)->right)->red){
+                NODE(t, NODE(t, w)->left)->red = false;
+                NODE(t, w)->red = true;
+                rotate_right(t, w);
+                w = NODE(t, parent)->right;
+            }
+            NODE(t, w)->red = NODE(t, parent)->red;
+            NODE(t, parent)->red = false;
+            NODE(t, NODE(t, w)->right)->red = false;
+            rotate_left(t, parent);
+        }else{
+            size_t w = NODE(t, parent)->left;
+            if (NODE(t, w)->red){
+                NODE(t, w)->red = false;
+                NODE(t, parent)->red = true;
+                rotate_right(t, parent);
+                w = NODE(t, parent)->left;
+            }
+            if (!NODE(t, NODE(t, w)->left)->red && !NODE(t, NODE(t, w)->right)->red){
+                NODE(t, w)->red = true;
+                x = parent;
+                continue;
+            }
+            if (!NODE(t, NODE(t, w)->left)->red){
+                NODE(t, NODE(t, w)->right)->red = false;
+                NODE(t, w)->red = true;
+                rotate_left(t, w);
+                w = NODE(t, parent)->left;
+            }
+            NODE(t, w)->red = NODE(t, parent)->red;
+            NODE(t, parent)->red = false;
+            NODE(t, NODE(t, w)->left)->red = false;
+            rotate_right(t, parent);
+        }
+        x = t->root;
+    }
+    NODE(t, x)->red = false;
+}
+
+// Treu order, que ha de ser a l'arbre
+void rbtree_remove(RBTree* t, size_t order){
+    RBNode* z = NODE(t, order);
+    // El primer no té fill esquerre: el següent és el mínim del subarbre
+    // dret o, si no en té, el pare
+    if (order == t->leftmost){
+        t->leftmost = z->right != t->nil ? minimum(t, z->right) : z->parent;
+        if (t->leftmost == t->nil){
+            t->leftmost = RB_NONE;
+        }
+    }
+
+    size_t y = order;
+    bool red = z->red;
+    size_t x;
+    if (z->left == t->nil){
+        x = z->right;
+        transplant(t, order, z->right);
+    }else if (z->right == t->nil){
+        x = z->left;
+        transplant(t, order, z->left);
+    }else{
+        y = minimum(t, z->right);
+        red = NODE(t, y)->red;
+        x = NODE(t, y)->right;
+        if (NODE(t, y)->parent == order){
+            NODE(t, x)->parent = y;
+        }else{
+            transplant(t, y, NODE(t, y)->right);
+            NODE(t, y)->right = z->right;
+            NODE(t, NODE(t, y)->right)->parent = y;
+        }
+        transplant(t, order, y);
+        NODE(t, y)->left = z->left;
+        NODE(t, NODE(t, y)->left)->parent = y;
+        NODE(t, y)->red = z->red;
+    }
+    if (!red){
+        remove_fixup(t, x);
+    }
+    t->size--;
+}
+
+size_t rbtree_first(RBTree* t){
+    return t->leftmost;
+}
+
+long long rbtree_key(RBTree* t, size_t order){
+    return NODE(t, order)->key;
+}
+
+size_t rbtree_size(RBTree* t){
+    return t->size;
+}
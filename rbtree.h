@@ -0,0 +1,41 @@
+#ifndef _RBTREE_H_
+#define _RBTREE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+# define RB_NONE ((size_t)-1)
+
+typedef struct _rbnode
+{
+    long long key;
+    size_t parent;
+    size_t left;
+    size_t right;
+    bool red;
+} RBNode;
+
+// Arbre roig-negre de processos, identificats per la seva posició a la
+// taula. Els nodes són d'un vector indexat per posició que poden
+// compartir diversos arbres si cada procés només és en un d'ells alhora
+// (p.ex. un arbre per CPU); l'últim node del vector és la fulla sentinella.
+// L'ordre és per clau i, si empaten, per posició. El primer es guarda a
+// part, de manera que consultar-lo és O(1); inserir i treure són O(log n).
+typedef struct _rbtree
+{
+    RBNode* nodes;
+    size_t nil;         // sentinella: nodes[nil]
+    size_t root;
+    size_t leftmost;    // primer en ordre, o RB_NONE
+    size_t size;
+} RBTree;
+
+RBNode* init_rbtree_nodes(size_t nprocs);
+void init_rbtree(RBTree* t, RBNode* nodes, size_t nprocs);
+void rbtree_insert(RBTree* t, size_t order, long long key);
+void rbtree_remove(RBTree* t, size_t order);
+size_t rbtree_first(RBTree* t);
+long long rbtree_key(RBTree* t, size_t order);
+size_t rbtree_size(RBTree* t);
+
+#endif
@@ -0,0 +1,234 @@
+#include <stdlib.h>
+#include "readyset.h"
+#include "stats.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define READYSET_X86
+# include <immintrin.h>
+#endif
+
+int num_kernels(void){
+    return sizeof(kernelsNames) / sizeof(char *);
+}
+
+// Millor nucli que pot executar la màquina
+int best_kernel(void){
+#ifdef READYSET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")){
+        return KERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")){
+        return KERNEL_SSE2;
+    }
+#endif
+    return KERNEL_SCALAR;
+}
+
+static size_t argmin_scalar(const int32_t* v, size_t n){
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++){
+        if (v[i] < v[best]){
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef READYSET_X86
+// Els nuclis vectorials fan dues passades: el mínim amb comparacions
+// vectorials i, després, la primera posició que el conté. La segona
+// passada acaba en trobar-lo.
+static size_t find_first(const int32_t* v, size_t i, size_t n, int32_t value){
+    while (i < n && v[i] != value){
+        i++;
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+static size_t argmin_sse2(const int32_t* v, size_t n){
+    // SSE2 no té min_epi32: es fa amb una comparació i una selecció
+    __m128i vmin = _mm_set1_epi32(INT32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        __m128i gt = _mm_cmpgt_epi32(vmin, x);
+        vmin = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, vmin));
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, vmin);
+    int32_t min = lanes[0];
+    for (int k = 1; k < 4; k++){
+        min = lanes[k] < min ? lanes[k] : min;
+    }
+    for (; i < n; i++){
+        min = v[i] < min ? v[i] : min;
+    }
+
+    __m128i target = _mm_set1_epi32(min);
+    for (i = 0; i + 4 <= n; i += 4){
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, target)));
+        if (mask != 0){
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+    return find_first(v, i, n, min);
+}
+
+__attribute__((target("avx2")))
+static size_t argmin_avx2(const int32_t* v, size_t n){
+    // Dos acumuladors per no encadenar cada min amb l'anterior
+    __m256i vmin0 = _mm256_set1_epi32(INT32_MAX);
+    __m256i vmin1 = vmin0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16){
+        vmin0 = _mm256_min_epi32(vmin0, _mm256_loadu_si256((const __m256i*)(v + i)));
+        vmin1 = _mm256_min_epi32(vmin1, _mm256_loadu_si256((const __m256i*)(v + i + 8)));
+    }
+    for (; i + 8 <= n; i += 8){
+        vmin0 = _mm256_min_epi32(vmin0, _mm256_loadu_si256((const __m256i*)(v + i)));
+    }
+    vmin0 = _mm256_min_epi32(vmin0, vmin1);
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(vmin0), _mm256_extracti128_si256(vmin0, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t min = _mm_cvtsi128_si32(half);
+    for (; i < n; i++){
+        min = v[i] < min ? v[i] : min;
+    }
+
+    __m256i target = _mm256_set1_epi32(min);
+    for (i = 0; i + 8 <= n; i += 8){
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, target)));
+        if (mask != 0){
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+    return find_first(v, i, n, min);
+}
+#endif
+
+// Posició del primer mínim de v (n > 0)
+size_t argmin_i32(const int32_t* v, size_t n, int kernel){
+#ifdef READYSET_X86
+    if (kernel == KERNEL_AVX2){
+        return argmin_avx2(v, n);
+    }
+    if (kernel == KERNEL_SSE2){
+        return argmin_sse2(v, n);
+    }
+#else
+    (void)kernel;
+#endif
+    return argmin_scalar(v, n);
+}
+
+static int32_t clamp_key(int key){
+    return key >= READY_NONE ? READY_NONE - 1 : key;
+}
+
+static int32_t readyset_key(ReadySet* r, Process* p){
+    return clamp_key(r->key(p));
+}
+
+// Un nucli que la màquina no suporta es substitueix pel millor disponible
+int init_readyset(ReadySet* r, Process* base, size_t nprocs, heap_key key, int kernel){
+    int best = best_kernel();
+    r->keys = malloc((nprocs > 0 ? nprocs : 1) * sizeof(int32_t));
+    if (r->keys == NULL){
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < nprocs; i++){
+        r->keys[i] = READY_NONE;
+    }
+    r->lo = 0;
+    r->hi = 0;
+    r->size = 0;
+    r->best = HEAP_NONE;
+    r->nprocs = nprocs;
+    r->base = base;
+    r->key = key;
+    r->kernel = kernel < 0 || kernel > best ? best : kernel;
+    return EXIT_SUCCESS;
+}
+
+size_t readyset_size(ReadySet* r){
+    return r->size;
+}
+
+bool readyset_before(ReadySet* r, Process* a, Process* b){
+    int32_t ka = readyset_key(r, a);
+    int32_t kb = readyset_key(r, b);
+    return ka < kb || (ka == kb && a < b);
+}
+
+int readyset_push(ReadySet* r, Process* p){
+    return readyset_push_key(r, p, r->key(p));
+}
+
+// Com readyset_push(), amb la clau ja calculada per qui crida
+int readyset_push_key(ReadySet* r, Process* p, int k){
+    size_t order = (size_t)(p - r->base);
+    if (order >= r->nprocs || r->keys[order] != READY_NONE){
+        return EXIT_FAILURE;
+    }
+    int32_t key = clamp_key(k);
+    r->keys[order] = key;
+    if (r->size == 0){
+        r->lo = order;
+        r->hi = order + 1;
+    }else{
+        r->lo = order < r->lo ? order : r->lo;
+        r->hi = order >= r->hi ? order + 1 : r->hi;
+    }
+    r->size++;
+    STATS_INC(STAT_READY_PUSHES);
+    // Si ja se sabia el mínim, n'hi ha prou de comparar-hi el nou
+    if (r->best != HEAP_NONE && (key < r->keys[r->best] || (key == r->keys[r->best] && order < r->best))){
+        r->best = order;
+    }
+    return EXIT_SUCCESS;
+}
+
+Process* readyset_peek(ReadySet* r){
+    if (r->size == 0){
+        return NULL;
+    }
+    if (r->best == HEAP_NONE){
+        r->best = r->lo + argmin_i32(r->keys + r->lo, r->hi - r->lo, r->kernel);
+    }
+    return &r->base[r->best];
+}
+
+// Treu el primer i estreny la finestra fins als extrems ocupats
+Process* readyset_pop(ReadySet* r){
+    Process* p = readyset_peek(r);
+    if (p == NULL){
+        return NULL;
+    }
+    r->keys[r->best] = READY_NONE;
+    r->best = HEAP_NONE;
+    r->size--;
+    STATS_INC(STAT_READY_POPS);
+    if (r->size == 0){
+        r->lo = 0;
+        r->hi = 0;
+        return p;
+    }
+    while (r->keys[r->lo] == READY_NONE){
+        r->lo++;
+    }
+    while (r->keys[r->hi - 1] == READY_NONE){
+        r->hi--;
+    }
+    return p;
+}
+
+void clean_readyset(ReadySet* r){
+    free(r->keys);
+    r->keys = NULL;
+    r->size = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef _READYSET_H_
+#define _READYSET_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "process.h"
+#include "heap.h"
+
+# define READY_NONE INT32_MAX
+
+// Nuclis de cerca del mínim. KERNEL_BEST tria el millor que suporti la
+// màquina en temps d'execució.
+enum kernels{KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+static const char * const kernelsNames[] = {
+	[KERNEL_SCALAR] = "scalar",
+	[KERNEL_SSE2] = "sse2",
+	[KERNEL_AVX2] = "avx2",
+};
+# define KERNEL_BEST -1
+
+// Cua de preparats en format d'estructura de vectors: només es guarda la
+// clau de cada procés de la taula base (READY_NONE si no hi és), de
+// manera que triar el següent és una cerca del mínim sobre un vector
+// contigu d'enters, sense tocar els Process. L'empat es resol per posició
+// a la taula, com al montícle. Les claus es fixen en inserir el procés;
+// una clau igual a INT32_MAX es compta com INT32_MAX - 1.
+typedef struct _readyset
+{
+    int32_t* keys;      // keys[order] = clau, o READY_NONE
+    size_t lo;          // finestra [lo, hi) que conté tots els processos
+    size_t hi;
+    size_t size;
+    size_t best;        // resultat de l'última cerca, o HEAP_NONE
+    size_t nprocs;
+    Process* base;
+    heap_key key;
+    int kernel;
+} ReadySet;
+
+int num_kernels(void);
+int best_kernel(void);
+int init_readyset(ReadySet* r, Process* base, size_t nprocs, heap_key key, int kernel);
+int readyset_push(ReadySet* r, Process* p);
+int readyset_push_key(ReadySet* r, Process* p, int key);
+Process* readyset_peek(ReadySet* r);
+Process* readyset_pop(ReadySet* r);
+bool readyset_before(ReadySet* r, Process* a, Process* b);
+size_t readyset_size(ReadySet* r);
+void clean_readyset(ReadySet* r);
+
+size_t argmin_i32(const int32_t* v, size_t n, int kernel);
+
+#endif
@@ -2,16 +2,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "process.h"
 #include "queue.h"
+#include "heap.h"
 #include "scheduler.h"
+#include "output.h"
+#include "stats.h"
 
-
-typedef int (*select_func)(Process*, size_t, int, int);
+// Hiperperíode màxim: amb períodes primers entre si el mínim comú múltiple
+// creix de pressa i la simulació no acabaria
+#define HYPERPERIOD_MAX (1 << 20)
 
 int num_algorithms()
 {
-    return sizeof(algorithmsNames) / sizeof(char *);
+    return num_policies();
 }
 
 int num_modalities()
@@ -19,311 +24,880 @@ int num_modalities()
     return sizeof(modalitiesNames) / sizeof(char *);
 }
 
-size_t initFromCSVFile(char *filename, Process **procTable)
+int num_backends()
 {
-    FILE *f = fopen(filename, "r");
+    return sizeof(backendsNames) / sizeof(char *);
+}
 
-    size_t procTableSize = 10;
+int num_placements()
+{
+    return sizeof(placementsNames) / sizeof(char *);
+}
 
-    *procTable = malloc(procTableSize * sizeof(Process));
-    Process *_procTable = *procTable;
+int num_balancings()
+{
+    return sizeof(balancingsNames) / sizeof(char *);
+}
 
-    if (f == NULL)
+size_t getTotalCPU(Process *procTable, size_t nprocs)
+{
+    size_t total = 0;
+    for (int p = 0; p < nprocs; p++)
     {
-        perror("initFromCSVFile():::Error Opening File:::");
-        exit(1);
+        total += (size_t)procTable[p].burst;
     }
+    return total;
+}
 
-    char *line = NULL;
-    size_t buffer_size = 0;
-    size_t nprocs = 0;
-    while (getline(&line, &buffer_size, f) != -1)
+// Instant en que acaba la simulació: l'última finalització d'un procés
+size_t getSimulationEnd(Process *procTable, size_t nprocs)
+{
+    size_t end = 0;
+    for (int p = 0; p < nprocs; p++)
     {
-        if (line != NULL)
+        if ((size_t)procTable[p].return_time > end)
         {
-            Process p = initProcessFromTokens(line, ";");
-
-            if (nprocs == procTableSize - 1)
-            {
-                procTableSize = procTableSize + procTableSize;
-                _procTable = realloc(_procTable, procTableSize * sizeof(Process));
-            }
-
-            _procTable[nprocs] = p;
-
-            nprocs++;
+            end = (size_t)procTable[p].return_time;
         }
     }
-    free(line);
-    fclose(f);
-    return nprocs;
+    return end;
 }
 
-size_t getTotalCPU(Process *procTable, size_t nprocs)
+// Horitzó per defecte de les tasques periòdiques: el mínim comú múltiple
+// dels períodes (com a molt HYPERPERIOD_MAX) a partir de l'última que
+// arriba, de manera que s'hi allibera un hiperperíode sencer de treballs.
+// 0 si no n'hi ha cap.
+int getHyperperiod(Process *procTable, size_t nprocs)
 {
-    size_t total = 0;
-    for (int p = 0; p < nprocs; p++)
+    long long lcm = 1;
+    int start = 0;
+    bool periodic = false;
+    for (size_t p = 0; p < nprocs; p++)
     {
-        total += (size_t)procTable[p].burst;
+        long long period = procTable[p].period;
+        if (period <= 0)
+        {
+            continue;
+        }
+        periodic = true;
+        start = procTable[p].arrive_time > start ? procTable[p].arrive_time : start;
+        long long a = lcm, b = period;
+        while (b != 0)
+        {
+            long long r = a % b;
+            a = b;
+            b = r;
+        }
+        lcm = lcm / a * period;
+        if (lcm > HYPERPERIOD_MAX)
+        {
+            lcm = HYPERPERIOD_MAX;
+        }
     }
-    return total;
+    if (!periodic)
+    {
+        return 0;
+    }
+    return (long long)start + lcm > INT_MAX ? INT_MAX : start + (int)lcm;
 }
 
-int getCurrentBurst(Process *proc, int current_time)
+// La clau d'EDF és el termini absolut, un int: l'últim alliberament d'una
+// tasca (abans de l'horitzó) més el seu termini hi ha de cabre. Retorna
+// EXIT_FAILURE i ho explica si algun procés no hi cap.
+static int checkDeadlines(Process *procTable, size_t nprocs, int horizon)
 {
-    int burst = 0;
-    for (int t = 0; t < current_time; t++)
+    for (size_t p = 0; p < nprocs; p++)
     {
-        if (proc->lifecycle[t] == Running)
+        const Process *proc = &procTable[p];
+        if (proc->deadline <= 0)
         {
-            burst++;
+            continue;
+        }
+        long long last = proc->arrive_time;
+        if (proc->period > 0 && proc->arrive_time < horizon)
+        {
+            last += (long long)(horizon - 1 - proc->arrive_time) / proc->period * proc->period;
+        }
+        if (last + proc->deadline > INT_MAX)
+        {
+            fprintf(stderr, "Process %s (id %d): absolute deadline %lld of the job released at %lld does not fit in an int\n",
+                    proc->name, proc->id, last + proc->deadline, last);
+            return EXIT_FAILURE;
         }
     }
-    return burst;
+    return EXIT_SUCCESS;
 }
 
-int run_dispatcher(Process *procTable, size_t nprocs, int algorithm, int modality, int quantum)
+// Prepara una simulació sobre procTable: la política reserva les seves
+// cues (una o més per processador). Els montícles comparteixen el vector
+// de posicions perquè un procés només és a una cua alhora. La taula no
+// es copia.
+int init_context(SimContext *ctx, Process *procTable, size_t nprocs, const SimOptions *options)
 {
-    qsort(procTable, nprocs, sizeof(Process), compareArrival);
+    memset(ctx, 0, sizeof(SimContext));
+    ctx->options = *options;
+    ctx->procTable = procTable;
+    ctx->nprocs = nprocs;
+    ctx->total = nprocs;
+    ctx->ncpus = options->cpus.ncpus > 0 ? options->cpus.ncpus : 1;
+    ctx->options.cpus.ncpus = ctx->ncpus;
+    ctx->policy = get_policy(options->algorithm);
+    ctx->useScan = options->backend != BACKEND_HEAP;
+    init_metrics(&ctx->metrics, options->verbose);
+    init_arena(&ctx->arena);
+
+    ctx->cpus = calloc((size_t)ctx->ncpus, sizeof(CPU));
+    ctx->positions = init_heap_positions(nprocs);
+    if (ctx->policy == NULL || ctx->cpus == NULL || ctx->positions == NULL)
+    {
+        clean_context(ctx);
+        return EXIT_FAILURE;
+    }
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        ctx->cpus[c].id = c;
+    }
+    if (ctx->policy->init != NULL && ctx->policy->init(ctx) != EXIT_SUCCESS)
+    {
+        clean_context(ctx);
+        return EXIT_FAILURE;
+    }
+    // Els processos bloquejats tampoc no són a cap cua de preparats: el
+    // montícle de despertars pot compartir el mateix vector de posicions
+    if (init_heap(&ctx->wakeups, procTable, nprocs, wakeupKey, ctx->positions) != EXIT_SUCCESS)
+    {
+        clean_context(ctx);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
 
-    init_queue();
-    size_t duration = getTotalCPU(procTable, nprocs) + 1;
+// Prepara una simulació que consumeix els processos del generador a
+// mesura que arriben: només hi ha una finestra de window processos vius
+// (0: STREAM_WINDOW), que fa de taula. Cada procés que acaba s'escriu a la
+// sortida CSV/JSON i deixa la seva posició lliure.
+int init_generated_context(SimContext *ctx, const Generator *gen, size_t window, const SimOptions *options)
+{
+    ProcStream *stream = malloc(sizeof(ProcStream));
+    if (stream == NULL || init_stream(stream, gen, window) != EXIT_SUCCESS)
+    {
+        free(stream);
+        memset(ctx, 0, sizeof(SimContext));
+        return EXIT_FAILURE;
+    }
+    if (init_context(ctx, stream->slots, stream->nslots, options) != EXIT_SUCCESS)
+    {
+        clean_stream(stream);
+        free(stream);
+        return EXIT_FAILURE;
+    }
+    ctx->stream = stream;
+    ctx->total = gen->nprocs;
+    return EXIT_SUCCESS;
+}
 
-    for (int p = 0; p < nprocs; p++)
+void clean_context(SimContext *ctx)
+{
+    if (ctx->policy != NULL && ctx->policy->clean != NULL)
+    {
+        ctx->policy->clean(ctx);
+    }
+    if (ctx->cpus != NULL)
     {
-        procTable[p].lifecycle = malloc(duration * sizeof(int));
-        for (int t = 0; t < duration; t++)
+        for (int c = 0; c < ctx->ncpus; c++)
         {
-            procTable[p].lifecycle[t] = -1;
+            cleanQueue(&ctx->cpus[c].fifo);
+            if (ctx->cpus[c].heap.nodes != NULL)
+            {
+                clean_heap(&ctx->cpus[c].heap);
+            }
+            if (ctx->cpus[c].ready.keys != NULL)
+            {
+                clean_readyset(&ctx->cpus[c].ready);
+            }
         }
-        procTable[p].waiting_time = 0;
-        procTable[p].return_time = 0;
-        procTable[p].response_time = -1; // Se cambia a -1, se queda en bucle
-        procTable[p].completed = false;
     }
+    if (ctx->wakeups.nodes != NULL)
+    {
+        clean_heap(&ctx->wakeups);
+    }
+    if (ctx->stream != NULL)
+    {
+        clean_stream(ctx->stream);
+        free(ctx->stream);
+    }
+    clean_metrics(&ctx->metrics);
+    clean_arena(&ctx->arena);
+    free(ctx->cpus);
+    free(ctx->positions);
+    ctx->cpus = NULL;
+    ctx->positions = NULL;
+    ctx->stream = NULL;
+}
 
-    //Selecció del algoritme
-    run_generic(procTable, nprocs, algorithm, modality, quantum);
+// Estat d'un procés abans d'arribar per primer cop
+static void resetProcess(Process *p)
+{
+    p->waiting_time = 0;
+    p->return_time = 0;
+    p->response_time = -1; // Es canvia a -1, si no es queda en bucle
+    p->completed = false;
+    p->executed = 0;
+    p->current = 0;
+    p->remaining = getBurst(p, 0);
+    p->entitled = 0;
+    p->release = p->arrive_time;
+    p->enqueued = p->arrive_time;
+    p->max_wait = 0;
+    p->jobs = 0;
+}
+
+// El generador s'ha aturat abans d'hora: la càrrega no cap al rellotge
+static int stream_overflow(SimContext *ctx)
+{
+    fprintf(stderr, "generator: arrivals plus total work exceed the simulation clock (%d) after %zu processes\n",
+            INT_MAX, ctx->stream->gen.produced);
+    return -1;
+}
 
-    printSimulation(nprocs, procTable, duration);
+// Executa la simulació del context. La taula s'ordena per arribada i se
+// n'actualitzen els temps; la història de cada procés s'allibera en
+// acabar. Amb un flux, la sortida CSV/JSON de cada procés s'escriu quan
+// acaba (en ordre de finalització) i el Gantt només mostra les mètriques,
+// perquè la taula no es conserva. Les mètriques queden a ctx->results.
+int run_dispatcher(SimContext *ctx)
+{
+    Process *procTable = ctx->procTable;
+    size_t nprocs = ctx->nprocs;
 
-    for (int p = 0; p < nprocs; p++)
+    if (ctx->stream == NULL && sortByArrival(procTable, nprocs) != EXIT_SUCCESS)
     {
-        destroyProcess(procTable[p]);
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    // L'arena torna a començar: les cues i la història de l'execució
+    // anterior desapareixen alhora
+    arena_reset(&ctx->arena);
+    if (ctx->policy->start != NULL && ctx->policy->start(ctx) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
     }
 
-    cleanQueue();
-    return EXIT_SUCCESS;
-}
+    if (ctx->stream != NULL)
+    {
+        // Els processos del generador no són periòdics ni tenen termini
+        stream_start(ctx->stream);
+        if (ctx->stream->gen.overflow)
+        {
+            return stream_overflow(ctx);
+        }
+        ctx->horizon = ctx->options.horizon;
+    }
+    else
+    {
+        for (int p = 0; p < nprocs; p++)
+        {
+            procTable[p].lifecycle = NULL;
+            procTable[p].lifecycle_size = 0;
+            procTable[p].lifecycle_capacity = 0;
+            resetProcess(&procTable[p]);
+        }
+        ctx->horizon = ctx->options.horizon > 0 ? ctx->options.horizon : getHyperperiod(procTable, nprocs);
+        if (checkDeadlines(procTable, nprocs, ctx->horizon) != EXIT_SUCCESS)
+        {
+            return -1;
+        }
+    }
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        ctx->cpus[c].running = NULL;
+        ctx->cpus[c].busy = 0;
+    }
+    clean_metrics(&ctx->metrics);
 
-void printSimulation(size_t nprocs, Process *procTable, size_t duration)
-{
+    // Tota la sortida passa per un únic buffer
+    int format = ctx->options.quiet ? -1 : ctx->options.format;
+    OutBuf ob;
+    if (format >= 0 && init_outbuf(&ob, stdout) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    ctx->out = ctx->stream != NULL && format >= 0 ? &ob : NULL;
 
-    printf("%14s", "== SIMULATION ");
-    for (int t = 0; t < duration; t++)
+    //Selecció del algoritme
+    if (format == FORMAT_GANTT)
+    {
+        outbuf_printf(&ob, "Ejecutando %s...\n", ctx->policy->name);
+    }
+    else if (format == FORMAT_CSV && ctx->stream != NULL)
+    {
+        writeCSVHeader(&ob, ctx->policy->share);
+    }
+    else if (format == FORMAT_JSON && ctx->stream != NULL)
     {
-        printf("%5s", "=====");
+        writeJSONHead(&ob, ctx);
     }
-    printf("\n");
+    STATS_TIMER_START(start);
+    int status = ctx->options.reference ? run_generic(ctx) : run_specialized(ctx);
+    STATS_TIMER_STOP(TIMER_RUN, start);
+    sort_metrics(&ctx->metrics);
+    computeResults(ctx);
 
-    printf("|%4s", "name");
-    for (int t = 0; t < duration; t++)
+    if (format == FORMAT_GANTT && ctx->stream == NULL)
+    {
+        size_t duration = getSimulationEnd(procTable, nprocs) + 1;
+        writeGantt(&ob, ctx, duration);
+        if (ctx->ncpus > 1)
+        {
+            writeCPUUsage(&ob, ctx->cpus, ctx->ncpus, duration - 1);
+        }
+        writeMetrics(&ob, &ctx->metrics);
+    }
+    else if (format == FORMAT_GANTT)
+    {
+        if (ctx->ncpus > 1)
+        {
+            writeCPUUsage(&ob, ctx->cpus, ctx->ncpus, ctx->results.duration);
+        }
+        writeMetrics(&ob, &ctx->metrics);
+    }
+    else if (format == FORMAT_CSV && ctx->stream == NULL)
+    {
+        writeSegmentsCSV(&ob, ctx);
+    }
+    else if (format == FORMAT_JSON && ctx->stream == NULL)
+    {
+        writeJSON(&ob, ctx);
+    }
+    else if (format == FORMAT_JSON)
+    {
+        writeJSONTail(&ob, ctx);
+    }
+    if (format >= 0)
     {
-        printf("|%2d", t);
+        clean_outbuf(&ob);
     }
-    printf("|\n");
+    ctx->out = NULL;
 
-    for (int p = 0; p < nprocs; p++)
+    // La història dels processos és a l'arena: no s'allibera procés a
+    // procés, sinó tota alhora a la propera execució o a clean_context()
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Compara la planificació de dos contexts executats sobre la mateixa taula
+static bool sameSchedule(const SimContext *a, const SimContext *b)
+{
+    const char *name = a->policy->name;
+    const char *modality = modalitiesNames[a->options.modality];
+    for (size_t p = 0; p < a->nprocs; p++)
     {
-        Process current = procTable[p];
-        printf("|%4s", current.name);
-        for (int t = 0; t < duration; t++)
+        const Process *pa = &a->procTable[p];
+        const Process *pb = &b->procTable[p];
+        if (pa->lifecycle_size != pb->lifecycle_size ||
+            (pa->lifecycle_size > 0 && memcmp(pa->lifecycle, pb->lifecycle, pa->lifecycle_size * sizeof(Segment)) != 0) ||
+            pa->waiting_time != pb->waiting_time || pa->response_time != pb->response_time ||
+            pa->return_time != pb->return_time)
         {
-            printf("|%2s", (current.lifecycle[t] == Running ? "E" : current.lifecycle[t] == Bloqued ? "B"
-                                                                : current.lifecycle[t] == Finished  ? "F"
-                                                                                                    : " "));
+            fprintf(stderr, "%s %s q=%d: process %s (id %d) differs\n", name, modality, a->options.quantum,
+                    pa->name, pa->id);
+            return false;
         }
-        printf("|\n");
     }
+    if (a->events != b->events)
+    {
+        fprintf(stderr, "%s %s q=%d: %zu events, reference %zu\n", name, modality, a->options.quantum,
+                a->events, b->events);
+        return false;
+    }
+    return true;
 }
 
-void printMetrics(size_t simulationCPUTime, size_t nprocs, Process *procTable)
+// Executa la configuració amb el bucle especialitzat i amb el genèric, cadascun
+// sobre una còpia de la taula, i comprova que la planificació és idèntica
+// procés a procés. Retorna EXIT_SUCCESS si coincideixen.
+int verify_specialized(Process *procTable, size_t nprocs, const SimOptions *options)
 {
+    Process *copies = malloc((nprocs > 0 ? 2 * nprocs : 1) * sizeof(Process));
+    if (copies == NULL || sortByArrival(procTable, nprocs) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(copies);
+        return EXIT_FAILURE;
+    }
+    memcpy(copies, procTable, nprocs * sizeof(Process));
+    memcpy(copies + nprocs, procTable, nprocs * sizeof(Process));
+
+    SimOptions specialized = *options;
+    specialized.quiet = true;
+    specialized.reference = false;
+    SimOptions reference = specialized;
+    reference.reference = true;
 
-    printf("%-14s", "== METRICS ");
-    for (int t = 0; t < simulationCPUTime + 1; t++)
+    SimContext ctx[2];
+    if (init_context(&ctx[0], copies, nprocs, &specialized) != EXIT_SUCCESS)
     {
-        printf("%5s", "=====");
+        fprintf(stderr, "Out of memory\n");
+        free(copies);
+        return EXIT_FAILURE;
     }
-    printf("\n");
+    if (init_context(&ctx[1], copies + nprocs, nprocs, &reference) != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Out of memory\n");
+        clean_context(&ctx[0]);
+        free(copies);
+        return EXIT_FAILURE;
+    }
+    int status = run_dispatcher(&ctx[0]) == EXIT_SUCCESS && run_dispatcher(&ctx[1]) == EXIT_SUCCESS &&
+                 sameSchedule(&ctx[0], &ctx[1]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    clean_context(&ctx[0]);
+    clean_context(&ctx[1]);
+    free(copies);
+    return status;
+}
 
-    printf("= Duration: %ld\n", simulationCPUTime);
-    printf("= Processes: %ld\n", nprocs);
+// Resultats agregats a partir de les mètriques acumulades durant la
+// simulació: no cal tornar a recórrer la taula de processos. La productivitat
+// compta treballs acabats (cada treball d'una tasca periòdica en suma un).
+void computeResults(SimContext *ctx)
+{
+    const Metrics *m = &ctx->metrics;
+    SimResults *results = &ctx->results;
+
+    memset(results, 0, sizeof(SimResults));
+    results->nprocs = ctx->total;
+    results->duration = (size_t)m->end;
+    results->events = ctx->events;
+    results->averageWaitingTime = m->all[METRIC_WAITING].mean;
+    results->averageResponseTime = m->all[METRIC_RESPONSE].mean;
+    results->averageReturnTime = m->all[METRIC_RETURN].mean;
+    results->averageReturnTimeN = m->all[METRIC_RETURN_N].mean;
+    results->p99WaitingTime = stat_percentile(&m->all[METRIC_WAITING], 99);
+    results->p99ResponseTime = stat_percentile(&m->all[METRIC_RESPONSE], 99);
+    results->maxWaitingTime = m->all[METRIC_MAX_WAIT].max;
+
+    size_t busy = 0;
+    for (int c = 0; c < ctx->ncpus; c++)
+    {
+        busy += ctx->cpus[c].busy;
+    }
+    if (results->duration > 0)
+    {
+        results->throughput = (double)m->all[METRIC_RETURN].n / (double)results->duration;
+        results->cpuUsage = (double)busy / ((double)results->duration * ctx->ncpus);
+    }
+}
 
-    size_t baselineCPUTime = getTotalCPU(procTable, nprocs);
-    double throughput = (double)nprocs / (double)simulationCPUTime;
-    double cpu_usage = (double)simulationCPUTime / (double)baselineCPUTime;
+// Forma del bucle de simulació. El genèric (RQ_POLICY) delega totes les
+// decisions en les funcions de la política; els especialitzats fixen la
+// cua i la forma com a constants, de manera que el compilador elimina les
+// branques que no s'hi apliquen i calcula la clau de les cues sense passar
+// pel punter heap_key.
+enum rqkinds{RQ_POLICY, RQ_FIFO, RQ_HEAP, RQ_SCAN};
+enum keykinds{KEY_DYNAMIC, KEY_REMAINING, KEY_PRIORITY};
+
+typedef struct _loopspec {
+    int rq;             // cua de preparats
+    int key;            // clau de SJF/Prioritats (KEY_DYNAMIC: la de la cua)
+    bool quantum;       // el tram pot acabar abans que la ràfega
+    bool preemptive;    // el primer de la cua pot expulsar el que s'executa
+} LoopSpec;
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+// Sense memòria per a la història d'un procés o per a les mètriques, la
+// simulació no pot continuar sense perdre dades
+static int out_of_memory(void) {
+    fprintf(stderr, "Out of memory\n");
+    return -1;
+}
 
-    printf("= CPU (Usage): %lf\n", cpu_usage * 100);
-    printf("= Throughput: %lf\n", throughput * 100);
+ALWAYS_INLINE int spec_key(LoopSpec s, Process *p) {
+    return s.key == KEY_REMAINING ? p->remaining : p->priority;
+}
 
-    double averageWaitingTime = 0;
-    double averageResponseTime = 0;
-    double averageReturnTime = 0;
-    double averageReturnTimeN = 0;
+ALWAYS_INLINE size_t rq_size(SimContext *ctx, LoopSpec s, CPU *c) {
+    if (s.rq == RQ_POLICY) return ctx->policy->size(ctx, c);
+    if (s.rq == RQ_SCAN) return readyset_size(&c->ready);
+    return s.rq == RQ_HEAP ? heap_size(&c->heap) : get_queue_size(&c->fifo);
+}
 
-    for (int p = 0; p < nprocs; p++)
-    {
-        averageWaitingTime += procTable[p].waiting_time;
-        averageResponseTime += procTable[p].response_time;
-        averageReturnTime += procTable[p].return_time;
-        averageReturnTimeN += procTable[p].return_time / (double)procTable[p].burst;
-    }
+// Encola proc a c. L'instant d'entrada serveix per a l'espera màxima i per
+// a la clau de Prioritats amb envelliment. Retorna -1 si la cua no té
+// memòria per al procés.
+ALWAYS_INLINE int rq_push(SimContext *ctx, LoopSpec s, CPU *c, Process *proc) {
+    int status;
+    proc->enqueued = ctx->clock;
+    if (s.rq == RQ_POLICY) status = ctx->policy->on_arrival(ctx, c, proc);
+    else if (s.rq == RQ_SCAN) {
+        if (s.key == KEY_DYNAMIC) status = readyset_push(&c->ready, proc);
+        else status = readyset_push_key(&c->ready, proc, spec_key(s, proc));
+    } else if (s.rq == RQ_HEAP) {
+        if (s.key == KEY_DYNAMIC) status = heap_push(&c->heap, proc);
+        else status = heap_push_key(&c->heap, proc, spec_key(s, proc));
+    } else status = enqueue(&c->fifo, proc);
+    return status == EXIT_SUCCESS ? 0 : out_of_memory();
+}
 
-    printf("= averageWaitingTime: %lf\n", (averageWaitingTime / (double)nprocs));
-    printf("= averageResponseTime: %lf\n", (averageResponseTime / (double)nprocs));
-    printf("= averageReturnTimeN: %lf\n", (averageReturnTimeN / (double)nprocs));
-    printf("= averageReturnTime: %lf\n", (averageReturnTime / (double)nprocs));
+// Treu el següent de c. A *slice hi queda el tram màxim que pot executar
+// (0: fins a acabar la ràfega)
+ALWAYS_INLINE Process *rq_pop(SimContext *ctx, LoopSpec s, CPU *c, int *slice) {
+    if (s.rq == RQ_POLICY) return ctx->policy->pick_next(ctx, c, slice);
+    *slice = s.quantum ? ctx->options.quantum : 0;
+    if (s.rq == RQ_SCAN) return readyset_pop(&c->ready);
+    return s.rq == RQ_HEAP ? heap_pop(&c->heap) : dequeue(&c->fifo);
 }
 
-size_t select_fcfs(Process *p, size_t n, int t, int q) {
-    for (size_t i = 0; i < n; i++) 
-        if (!p[i].completed && p[i].arrive_time <= t) return i; // FCFS: primer proceso que haya llegado y no esté completado
-    return (size_t)-1; // ningún proceso disponible
+// Torna a encolar a c el procés que deixa la CPU sense acabar la ràfega
+ALWAYS_INLINE int rq_requeue(SimContext *ctx, LoopSpec s, CPU *c, Process *cur) {
+    if (s.rq != RQ_POLICY) return rq_push(ctx, s, c, cur);
+    cur->enqueued = ctx->clock;
+    return ctx->policy->on_preempt(ctx, c, cur) == EXIT_SUCCESS ? 0 : out_of_memory();
 }
 
-size_t select_sjf(Process *p, size_t n, int t, int pre) {
-    size_t pos = (size_t)-1; int rem = 0;
-    for (size_t i = 0; i < n; i++) if (!p[i].completed && p[i].arrive_time <= t) {
-        int r = pre ? p[i].burst - getCurrentBurst(&p[i], t) : p[i].burst; // preemptivo = tiempo restante, no preemptivo = burst total
-        if (pos == (size_t)-1 || r < rem) { pos = i; rem = r; } // elegir el más corto
+// El primer de la cua de c ha d'expulsar cur. Als especialitzats (només
+// SJF/Prioritats): clau menor o, si empaten, anterior a la taula
+ALWAYS_INLINE bool rq_preempts(SimContext *ctx, LoopSpec s, CPU *c, Process *cur) {
+    if (s.rq == RQ_POLICY) return ctx->policy->preempts != NULL && ctx->policy->preempts(ctx, c, cur);
+    Process *top = s.rq == RQ_SCAN ? readyset_peek(&c->ready) : heap_peek(&c->heap);
+    if (top == NULL) return false;
+    if (s.key == KEY_DYNAMIC) {
+        return s.rq == RQ_SCAN ? readyset_before(&c->ready, top, cur) : heap_before(&c->heap, top, cur);
+    }
+    int a = spec_key(s, top), b = spec_key(s, cur);
+    if (s.rq == RQ_SCAN) { // el ReadySet reserva INT32_MAX per a les posicions buides
+        a = a >= READY_NONE ? READY_NONE - 1 : a;
+        b = b >= READY_NONE ? READY_NONE - 1 : b;
     }
-    return pos; // devuelve índice del proceso más corto
+    return a < b || (a == b && top < cur);
 }
 
-size_t select_priority(Process *p, size_t n, int t, int pre) {
-    size_t pos = (size_t)-1;
-    for (size_t i = 0; i < n; i++) if (!p[i].completed && p[i].arrive_time <= t)
-        if (pos == (size_t)-1 || p[i].priority < p[pos].priority) pos = i; // elegir el de mayor prioridad (menor valor numérico)
-    return pos;
+// Tria la CPU on s'encola un procés que arriba
+ALWAYS_INLINE CPU *place(SimContext *ctx, LoopSpec s) {
+    if (ctx->options.cpus.placement == PLACE_RR) {
+        CPU *c = &ctx->cpus[ctx->next_cpu];
+        ctx->next_cpu = (ctx->next_cpu + 1) % ctx->ncpus;
+        return c;
+    }
+    // PLACE_LEAST: la CPU amb menys processos (a la cua + en execució)
+    CPU *best = &ctx->cpus[0];
+    size_t best_load = rq_size(ctx, s, best) + (best->running != NULL);
+    for (int i = 1; i < ctx->ncpus; i++) {
+        size_t load = rq_size(ctx, s, &ctx->cpus[i]) + (ctx->cpus[i].running != NULL);
+        if (load < best_load) { best = &ctx->cpus[i]; best_load = load; }
+    }
+    return best;
 }
 
-void enqueue_arrivals(Process *p, size_t n, int t, bool *enq) {
-    for (size_t i = 0; i < n; i++) {
-        if (!p[i].completed && p[i].arrive_time <= t && !enq[i]) {
-            enqueue(&p[i]);
-            enq[i] = true;
-        }
+// Un procés del flux arriba: ocupa una posició de la finestra. Retorna
+// NULL i ho explica si la finestra és plena o el generador s'ha aturat per
+// desbordament.
+static Process *admit_stream(SimContext *ctx) {
+    Process *p = stream_admit(ctx->stream);
+    if (p == NULL) {
+        fprintf(stderr, "More than %zu processes alive at t=%d: raise --window\n", ctx->nprocs, ctx->clock);
+        return NULL;
     }
+    resetProcess(p);
+    if (!ctx->stream->pending && ctx->stream->gen.overflow) {
+        stream_overflow(ctx);
+        return NULL;
+    }
+    return p;
 }
 
-int run_generic(Process *p, size_t n, int alg, int mod, int q) {
-    printf("Ejecutando %s...\n", algorithmsNames[alg]);
+// Instant de la següent arribada a *t; false si ja han arribat tots. Amb
+// un flux, el generador ja l'ha produït però encara no ocupa cap posició.
+ALWAYS_INLINE bool next_arrival(SimContext *ctx, int *t) {
+    if (ctx->stream != NULL) {
+        *t = ctx->stream->next.arrive_time;
+        return ctx->stream->pending;
+    }
+    if (ctx->arrived >= ctx->nprocs) return false;
+    *t = ctx->procTable[ctx->arrived].arrive_time;
+    return true;
+}
 
-    int t = 0;
-    size_t done = 0;
+// Els processos arriben en ordre: un cursor avança sobre la taula ordenada
+// (o el generador), així que cada procés s'admet una sola vegada i, quan
+// n'arriben diversos alhora, en ordre de taula
+ALWAYS_INLINE int enqueue_arrivals(SimContext *ctx, LoopSpec s) {
+    int t;
+    while (next_arrival(ctx, &t) && t <= ctx->clock) {
+        Process *p = ctx->stream != NULL ? admit_stream(ctx) : &ctx->procTable[ctx->arrived];
+        if (p == NULL || rq_push(ctx, s, place(ctx, s), p) != 0) return -1;
+        ctx->arrived++;
+        STATS_INC(STAT_ARRIVALS);
+    }
+    return 0;
+}
 
-    // Marca local para saber si cada proceso ya fue encolado al menos una vez
-    bool *enq = calloc(n, sizeof(bool));
-    if (!enq) return -1;
+// Un procés del flux ha acabat del tot: s'escriu i la seva posició queda
+// lliure per a una altra arribada
+static void retire_stream(SimContext *ctx, Process *p) {
+    if (ctx->out != NULL && ctx->options.format == FORMAT_CSV) writeProcessCSV(ctx->out, p, ctx->policy->share);
+    else if (ctx->out != NULL && ctx->options.format == FORMAT_JSON) writeProcessJSON(ctx->out, p, ctx->done == 1);
+    stream_release(ctx->stream, p);
+}
 
-    while (done < n) {
-        // Encolar todo lo que ya haya llegado y no esté en cola
-        enqueue_arrivals(p, n, t, enq);
 
-        // Si no hay nada que ejecutar, avanzar el tiempo
-        if (!get_queue_size()) { t++; continue; }
+// Comptabilitza el que ha executat la CPU des de l'inici del tram fins a t.
+// Retorna -1 si no hi ha memòria per al tram.
+ALWAYS_INLINE int checkpoint(SimContext *ctx, LoopSpec s, CPU *c, int t) {
+    Process *cur = c->running;
+    if (cur == NULL || t <= c->slice_start) return 0;
+    int run = t - c->slice_start;
+    if (addSegment(cur, &ctx->arena, c->slice_start, t, Running, c->id) != EXIT_SUCCESS) return out_of_memory();
+    cur->executed += run;
+    cur->remaining -= run;
+    c->busy += (size_t)run;
+    c->slice_start = t;
+    if (s.rq == RQ_POLICY && ctx->policy->on_tick != NULL) ctx->policy->on_tick(ctx, c, cur, run);
+    return 0;
+}
 
-        // Tomar candidato de la cola
-        Process *cur = dequeue();
+// Final de l'última ràfega del treball en curs. Una tasca periòdica es
+// torna a alliberar mentre el següent alliberament caigui abans de
+// l'horitzó: si ja ha passat (el treball s'ha endarrerit) torna
+// directament a una cua de preparats i, si no, espera al montícle de
+// despertars com una E/S. Compta a ctx->done els processos que acaben del
+// tot. Retorna -1 si no hi ha memòria per a les mètriques o per tornar a
+// encolar el treball següent.
+ALWAYS_INLINE int complete_process(SimContext *ctx, LoopSpec s, CPU *c, Process *cur, int t) {
+    long long next = (long long)cur->arrive_time + (long long)(cur->jobs + 1) * cur->period;
+    cur->jobs++;
+    STATS_INC(STAT_COMPLETIONS);
+    cur->completed = cur->period <= 0 || next >= ctx->horizon;
+    cur->return_time = t;
+    cur->waiting_time = t - cur->release - cur->burst - cur->io_time;
+    if (s.rq == RQ_POLICY && ctx->policy->on_complete != NULL) ctx->policy->on_complete(ctx, c, cur);
+    if (record_metrics(&ctx->metrics, cur) != EXIT_SUCCESS) return out_of_memory();
+    if (cur->completed) {
+        ctx->done++;
+        if (ctx->stream != NULL) retire_stream(ctx, cur);
+        return 0;
+    }
 
-        // Si el proceso ya se completó (pudo completarse justo al encolarse/reevaluarse), saltar
-        if (cur->completed) continue;
+    cur->current = 0;
+    cur->remaining = getBurst(cur, 0);
+    cur->response_time = -1;
+    cur->max_wait = 0;
+    cur->release = (int)next;
+    if (cur->release <= t) return rq_push(ctx, s, place(ctx, s), cur);
+    cur->wakeup = cur->release;
+    return heap_push(&ctx->wakeups, cur) == EXIT_SUCCESS ? 0 : out_of_memory();
+}
 
-        // Selección “mejor” proceso desde la cola para SJF/Prioridades
-        if (alg == SJF || alg == PRIORITIES) {
-            size_t size = get_queue_size();
-            Process *best = cur;
+// El rellotge és un int: un instant que no hi cap és un error de la
+// càrrega, no un esdeveniment
+static int clock_overflow(SimContext *ctx, long long t) {
+    fprintf(stderr, "Simulation clock overflow at t=%d: next event at %lld does not fit in an int\n", ctx->clock, t);
+    return -1;
+}
 
-            for (size_t i = 0; i < size; i++) {
-                Process *tmp = dequeue();
-                if (tmp->completed) { continue; } // ignorar completados
+// Final d'una ràfega de CPU que no és l'última: el procés passa a E/S i
+// espera al montícle de despertars (les E/S se solapen entre si). Amb una
+// E/S nul·la torna directament a una cua de preparats. Retorna -1 si el
+// final de l'E/S no cap al rellotge o no hi ha memòria per al tram o per a
+// les cues.
+ALWAYS_INLINE int block_process(SimContext *ctx, LoopSpec s, CPU *c, Process *cur, int t) {
+    if (s.rq == RQ_POLICY && ctx->policy->on_block != NULL) ctx->policy->on_block(ctx, c, cur);
+    int io = getBurst(cur, cur->current + 1);
+    cur->current += 2;
+    cur->remaining = getBurst(cur, cur->current);
+    STATS_INC(STAT_BLOCKS);
+    if (io == 0) return rq_push(ctx, s, place(ctx, s), cur);
+    if ((long long)t + io > INT_MAX) return clock_overflow(ctx, (long long)t + io);
+    cur->wakeup = t + io;
+    if (addSegment(cur, &ctx->arena, t, cur->wakeup, Bloqued, -1) != EXIT_SUCCESS) return out_of_memory();
+    return heap_push(&ctx->wakeups, cur) == EXIT_SUCCESS ? 0 : out_of_memory();
+}
 
-                int better =
-                    (alg == SJF)
-                        ? (tmp->burst - getCurrentBurst(tmp, t) <
-                           best->burst - getCurrentBurst(best, t))
-                        : (tmp->priority < best->priority);
+// Els processos amb l'E/S acabada a t tornen a les cues de preparats
+ALWAYS_INLINE int wake_processes(SimContext *ctx, LoopSpec s) {
+    while (heap_size(&ctx->wakeups) && heap_peek(&ctx->wakeups)->wakeup <= ctx->clock) {
+        if (rq_push(ctx, s, place(ctx, s), heap_pop(&ctx->wakeups)) != 0) return -1;
+        STATS_INC(STAT_WAKEUPS);
+    }
+    return 0;
+}
 
-                if (better) {
-                    enqueue(best);
-                    best = tmp;
-                } else {
-                    enqueue(tmp);
-                }
-            }
-            cur = best;
-        }
+// Una CPU sense feina roba el millor procés de la CPU amb la cua més llarga
+ALWAYS_INLINE Process *steal(SimContext *ctx, LoopSpec s, CPU *thief, int *slice) {
+    CPU *victim = NULL;
+    size_t longest = 0;
+    for (int i = 0; i < ctx->ncpus; i++) {
+        size_t size = rq_size(ctx, s, &ctx->cpus[i]);
+        if (&ctx->cpus[i] != thief && size > longest) { victim = &ctx->cpus[i]; longest = size; }
+    }
+    return victim != NULL ? rq_pop(ctx, s, victim, slice) : NULL;
+}
 
-        // Ejecutar según algoritmo/modo
-        if (alg == RR) {
-            // Round Robin
-            int rem = cur->burst - getCurrentBurst(cur, t);
-            int run = (rem < q ? rem : q);
+// Retorna -1 si el final del tram no cap al rellotge
+ALWAYS_INLINE int dispatch(SimContext *ctx, LoopSpec s, CPU *c) {
+    int t = ctx->clock;
+    int slice = 0;
+    Process *cur = rq_pop(ctx, s, c, &slice);
+    if (cur == NULL && ctx->options.cpus.balancing == BALANCE_STEAL) {
+        cur = steal(ctx, s, c, &slice);
+        if (cur != NULL) STATS_INC(STAT_STEALS);
+    }
+    if (cur == NULL) return 0;
+    STATS_INC(STAT_DISPATCHES);
+
+    if (cur->response_time < 0) cur->response_time = t - cur->release;
+    if (t - cur->enqueued > cur->max_wait) cur->max_wait = t - cur->enqueued;
+    c->running = cur;
+    c->slice_start = t;
+    // El tram que dona la cua (RR: un quantum) o fins a acabar la ràfega (les
+    // arribades que el puguin expulsar són esdeveniments propis)
+    long long end = (long long)t + ((slice > 0 && slice < cur->remaining) ? slice : cur->remaining);
+    if (end > INT_MAX) return clock_overflow(ctx, end);
+    c->slice_end = (int)end;
+    return 0;
+}
 
-            if (cur->response_time < 0) cur->response_time = t - cur->arrive_time;
+// Bucle de simulació per a la forma s. Només es crida des de run_generic()
+// i des de les especialitzacions, que l'expandeixen cadascuna amb la seva
+// forma.
+ALWAYS_INLINE int run_loop(SimContext *ctx, LoopSpec s) {
+    CPU *cpus = ctx->cpus;
+
+    ctx->clock = 0;
+    ctx->done = 0;
+    ctx->events = 0;
+    ctx->next_cpu = 0;
+    ctx->arrived = 0;
+
+    while (ctx->done < ctx->total) {
+        int t = ctx->clock;
+        ctx->events++;
+        STATS_INC(STAT_ITERATIONS);
+
+        // Comptabilitzar el que han executat les CPUs fins a t abans d'admetre
+        // ningú: les polítiques col·loquen els que arriben respecte del temps
+        // virtual (CFS) o la passa (stride) mínims, que inclouen el que
+        // s'executa
+        for (int i = 0; i < ctx->ncpus; i++) {
+            if (checkpoint(ctx, s, &cpus[i], t) != 0) return -1;
+        }
 
-            for (int k = t; k < t + run; k++) cur->lifecycle[k] = Running;
-            t += run;
+        // Encolar tot el que ja ha arribat i no és a cap cua, i després el que
+        // acaba l'E/S
+        if (enqueue_arrivals(ctx, s) != 0 || wake_processes(ctx, s) != 0) return -1;
+
+        // Tancar els trams que acaben a t i, en mode preemptiu, expulsar el
+        // procés en execució si el primer de la seva cua és millor
+        for (int i = 0; i < ctx->ncpus; i++) {
+            CPU *c = &cpus[i];
+            Process *cur = c->running;
+            if (cur == NULL) continue;
+            if (cur->remaining == 0 && cur->current + 1 < cur->nbursts) {
+                c->running = NULL;
+                if (block_process(ctx, s, c, cur, t) != 0) return -1;
+            } else if (cur->remaining == 0) {
+                c->running = NULL;
+                if (complete_process(ctx, s, c, cur, t) != 0) return -1;
+            } else if (s.quantum && t == c->slice_end) {
+                if (rq_requeue(ctx, s, c, cur) != 0) return -1;
+                c->running = NULL;
+                STATS_INC(STAT_SLICE_ENDS);
+            } else if (s.preemptive && rq_preempts(ctx, s, c, cur)) {
+                if (rq_requeue(ctx, s, c, cur) != 0) return -1;
+                c->running = NULL;
+                STATS_INC(STAT_PREEMPTIONS);
+            }
+        }
 
-            // Encolar nuevas llegadas durante el quantum (sin duplicar)
-            enqueue_arrivals(p, n, t, enq);
+        // Les CPUs lliures prenen el següent procés de la seva cua (o el roben)
+        for (int i = 0; i < ctx->ncpus; i++) {
+            if (cpus[i].running == NULL && dispatch(ctx, s, &cpus[i]) != 0) return -1;
+        }
 
-            // ¿Terminó?
-            if (cur->burst - getCurrentBurst(cur, t) == 0) {
-                cur->completed = true;
-                cur->return_time = t;
-                cur->waiting_time = t - cur->arrive_time - cur->burst;
-                done++;
-            } else {
-                enqueue(cur);
-            }
-        } else if ((alg == SJF && mod == PREEMPTIVE) ||
-                   (alg == PRIORITIES && mod == PREEMPTIVE)) {
-            // Un tick y reevaluar
-            cur->lifecycle[t] = Running;
-            if (cur->response_time < 0) cur->response_time = t - cur->arrive_time;
-            t++;
-
-            // Encolar nuevas llegadas (sin duplicar)
-            enqueue_arrivals(p, n, t, enq);
-
-            // ¿Terminó?
-            if (getCurrentBurst(cur, t) == cur->burst) {
-                cur->completed = true;
-                cur->return_time = t;
-                cur->waiting_time = t - cur->arrive_time - cur->burst;
-                done++;
-            } else {
-                enqueue(cur);
+        // Saltar al següent esdeveniment: una arribada, un despertar o el final d'un tram
+        int next = 0;
+        bool pending = next_arrival(ctx, &next);
+        if (heap_size(&ctx->wakeups) && (!pending || heap_peek(&ctx->wakeups)->wakeup < next)) {
+            next = heap_peek(&ctx->wakeups)->wakeup;
+            pending = true;
+        }
+        for (int i = 0; i < ctx->ncpus; i++) {
+            if (cpus[i].running != NULL && (!pending || cpus[i].slice_end < next)) {
+                next = cpus[i].slice_end;
+                pending = true;
             }
-        } else {
-            // FCFS / SJF no-preemptivo / Prioridades no-preemptivo
-            if (cur->response_time < 0) cur->response_time = t - cur->arrive_time;
+        }
+        if (!pending) break;
+        if (next > t + 1) STATS_ADD(STAT_SKIPPED, next - t - 1);
+        ctx->clock = next;
+    }
 
-            for (int k = t; k < t + cur->burst; k++) cur->lifecycle[k] = Running;
-            t += cur->burst;
+    if (ctx->done < ctx->total) {
+        fprintf(stderr, "Simulation stalled at t=%d with %zu of %zu processes unfinished\n", ctx->clock,
+                ctx->total - ctx->done, ctx->total);
+        return -1;
+    }
+    return 0;
+}
 
-            cur->completed = true;
-            cur->return_time = t;
-            cur->waiting_time = cur->return_time - cur->arrive_time - cur->burst;
-            done++;
+// Implementació de referència: cada decisió passa per la política, sigui
+// quina sigui
+int run_generic(SimContext *ctx) {
+    LoopSpec s = {RQ_POLICY, KEY_DYNAMIC, true, true};
+    return run_loop(ctx, s);
+}
 
-            // Encolar nuevas llegadas al terminar (sin duplicar)
-            enqueue_arrivals(p, n, t, enq);
-        }
+// Una funció per forma del bucle, amb la forma com a constant
+#define SPECIALIZE(name, rq, key, quantum, preemptive) \
+    static int name(SimContext *ctx) { \
+        LoopSpec s = {rq, key, quantum, preemptive}; \
+        return run_loop(ctx, s); \
     }
 
-    free(enq);
-    return 0;
-}
\ No newline at end of file
+SPECIALIZE(run_fifo, RQ_FIFO, KEY_DYNAMIC, false, false)
+SPECIALIZE(run_rr, RQ_FIFO, KEY_DYNAMIC, true, false)
+SPECIALIZE(run_sjf_heap, RQ_HEAP, KEY_REMAINING, false, false)
+SPECIALIZE(run_sjf_heap_pre, RQ_HEAP, KEY_REMAINING, false, true)
+SPECIALIZE(run_prio_heap, RQ_HEAP, KEY_PRIORITY, false, false)
+SPECIALIZE(run_prio_heap_pre, RQ_HEAP, KEY_PRIORITY, false, true)
+SPECIALIZE(run_sjf_scan, RQ_SCAN, KEY_REMAINING, false, false)
+SPECIALIZE(run_sjf_scan_pre, RQ_SCAN, KEY_REMAINING, false, true)
+SPECIALIZE(run_prio_scan, RQ_SCAN, KEY_PRIORITY, false, false)
+SPECIALIZE(run_prio_scan_pre, RQ_SCAN, KEY_PRIORITY, false, true)
+
+typedef int (*loop_func)(SimContext *ctx);
+
+// Especialització que correspon a les opcions, o NULL si la política no en
+// té (les que no són predefinides i Prioritats amb envelliment, la clau de
+// la qual depèn del rellotge)
+static loop_func specialized_loop(const SimOptions *o) {
+    bool pre = o->modality == PREEMPTIVE;
+    bool scan = o->backend != BACKEND_HEAP;
+    switch (o->algorithm) {
+    case FCFS:
+        return run_fifo;
+    case RR:
+        return run_rr;
+    case SJF:
+        if (scan) return pre ? run_sjf_scan_pre : run_sjf_scan;
+        return pre ? run_sjf_heap_pre : run_sjf_heap;
+    case PRIORITIES:
+        if (o->aging > 0) return NULL;
+        if (scan) return pre ? run_prio_scan_pre : run_prio_scan;
+        return pre ? run_prio_heap_pre : run_prio_heap;
+    default:
+        return NULL;
+    }
+}
+
+bool has_specialized(const SimOptions *options) {
+    return specialized_loop(options) != NULL;
+}
+
+// Executa l'especialització que correspon a les opcions del context. Les
+// configuracions sense especialització fan servir el bucle genèric.
+int run_specialized(SimContext *ctx) {
+    loop_func loop = specialized_loop(&ctx->options);
+    return loop != NULL ? loop(ctx) : run_generic(ctx);
+}
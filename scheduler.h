@@ -1,13 +1,17 @@
 #ifndef __SCHEDULER__
 #define __SCHEDULER__
 
-enum algorithms{FCFS, SJF, RR, PRIORITIES}; 
-static const char * const algorithmsNames[] = {
-	[FCFS] = "fcfs",
-	[SJF] = "sjf",
-    [RR] = "rr",
-    [PRIORITIES] = "priorities",
-};
+#include "queue.h"
+#include "heap.h"
+#include "readyset.h"
+#include "metrics.h"
+#include "policy.h"
+#include "stream.h"
+
+// Algorismes predefinits, amb bucle especialitzat. Són les primeres
+// posicions del registre de polítiques (policy.h); la resta de polítiques
+// només hi són al registre.
+enum algorithms{FCFS, SJF, RR, PRIORITIES};
 
 enum modalities{PREEMPTIVE, NONPREEMPTIVE}; 
 static const char * const modalitiesNames[] = {
@@ -15,22 +19,139 @@ static const char * const modalitiesNames[] = {
 	[NONPREEMPTIVE] = "nonpreemptive",
 };
 
+// Ubicació dels processos que arriben: per torns o a la CPU menys carregada
+enum placements{PLACE_RR, PLACE_LEAST};
+static const char * const placementsNames[] = {
+	[PLACE_RR] = "rr",
+	[PLACE_LEAST] = "least",
+};
+
+// Equilibri de càrrega: una CPU sense feina pot robar de la cua més llarga
+enum balancings{BALANCE_NONE, BALANCE_STEAL};
+static const char * const balancingsNames[] = {
+	[BALANCE_NONE] = "none",
+	[BALANCE_STEAL] = "steal",
+};
+
+// Cua de preparats de SJF/Prioritats/EDF/RM: el montícle indexat o un vector de
+// claus (ReadySet) que es recorre amb el nucli escalar o el vectorial
+enum backends{BACKEND_HEAP, BACKEND_SCALAR, BACKEND_SIMD};
+static const char * const backendsNames[] = {
+	[BACKEND_HEAP] = "heap",
+	[BACKEND_SCALAR] = "scalar",
+	[BACKEND_SIMD] = "simd",
+};
+
+typedef struct _cpuconfig
+{
+    int ncpus;
+    int placement;
+    int balancing;
+} CPUConfig;
+
+// Processador simulat: la seva cua de preparats i el tram en execució
+typedef struct _cpu
+{
+    int id;
+    Queue fifo;         // FCFS/RR
+    Heap heap;          // SJF/Prioritats
+    ReadySet ready;     // SJF/Prioritats amb BACKEND_SCALAR o BACKEND_SIMD
+    Process *running;
+    int slice_start;
+    int slice_end;
+    size_t busy;        // temps executant processos
+} CPU;
+
+// Paràmetres d'una simulació
+typedef struct _simoptions
+{
+    int algorithm;
+    int modality;
+    int quantum;
+    CPUConfig cpus;
+    bool quiet;         // no imprimir la simulació
+    bool verbose;       // mètriques també per prioritat
+    int format;         // FORMAT_GANTT, FORMAT_CSV o FORMAT_JSON
+    int width;          // columnes del diagrama de Gantt (0: per defecte)
+    int backend;        // cua de preparats de SJF/Prioritats/EDF/RM
+    bool reference;     // bucle genèric de referència en lloc de l'especialitzat
+    uint64_t seed;      // llavor de les polítiques aleatòries (loteria)
+    int horizon;        // últim alliberament de les tasques periòdiques (0: l'hiperperíode)
+    int aging;          // Prioritats: un nivell cada aging unitats d'espera (0: sense envelliment)
+} SimOptions;
+
+// Mètriques agregades d'una simulació
+typedef struct _simresults
+{
+    size_t nprocs;
+    size_t duration;
+    double averageWaitingTime;
+    double averageResponseTime;
+    double averageReturnTime;
+    double averageReturnTimeN;
+    double p99WaitingTime;
+    double p99ResponseTime;
+    double maxWaitingTime;  // espera més llarga d'una sola vegada a la cua
+    double throughput;
+    double cpuUsage;
+    size_t events;      // instants de planificació processats
+} SimResults;
+
+// Estat complet d'una simulació: opcions, taula de processos, cues de
+// preparats (una per CPU), rellotge i resultats. No hi ha cap estat global,
+// de manera que es poden executar diverses simulacions alhora. Amb un
+// generador (init_generated_context()), procTable és la finestra de
+// processos vius del flux i nprocs la seva mida.
+typedef struct _simcontext
+{
+    SimOptions options;
+    Process *procTable;
+    size_t nprocs;
+    size_t total;       // processos de l'execució (amb un flux, tots els del generador)
+    ProcStream *stream; // NULL: la taula sencera és a procTable
+    OutBuf *out;        // amb un flux, cada procés s'escriu aquí en acabar
+    CPU *cpus;
+    int ncpus;
+    const Policy *policy;
+    void *policy_state; // estat privat de la política
+    bool useScan;       // SJF/Prioritats amb ReadySet en lloc del montícle
+    Heap wakeups;       // processos bloquejats, per instant de despertar
+    size_t *positions;  // vector de posicions compartit pels montícles
+    size_t arrived;     // processos de la taula (ordenada per arribada) ja admesos
+    int next_cpu;       // següent CPU per a la ubicació per torns
+    int clock;
+    int horizon;        // les tasques periòdiques s'alliberen abans d'aquest instant
+    size_t done;
+    size_t events;
+    Metrics metrics;    // s'acumulen a cada procés acabat
+    Arena arena;        // cues FIFO i història dels processos d'una execució
+    SimResults results;
+} SimContext;
+
 int num_algorithms(void);
 int num_modalities(void);
+int num_placements(void);
+int num_balancings(void);
+int num_backends(void);
 
-size_t initFromCSVFile(char* filename, Process** procTable);
-
-int run_dispatcher(Process *procTable, size_t nprocs, int algorithm, int modality, int quantum);
-void printMetrics(size_t simulationCPUTime, size_t nprocs, Process *procTable );
-void printSimulation(size_t nprocs, Process *procTable, size_t duration);
-int getCurrentBurst(Process* proc, int current_time);
+int init_context(SimContext *ctx, Process *procTable, size_t nprocs, const SimOptions *options);
+int init_generated_context(SimContext *ctx, const Generator *gen, size_t window, const SimOptions *options);
+void clean_context(SimContext *ctx);
+int run_dispatcher(SimContext *ctx);
+void computeResults(SimContext *ctx);
+int verify_specialized(Process *procTable, size_t nprocs, const SimOptions *options);
+bool has_specialized(const SimOptions *options);
 size_t getTotalCPU(Process *procTable, size_t nprocs);
+size_t getSimulationEnd(Process *procTable, size_t nprocs);
+int getHyperperiod(Process *procTable, size_t nprocs);
 
-// Prototips de les funcions auxiliars
-int run_generic(Process *p, size_t n, int alg, int mod, int q);
-size_t select_fcfs(Process *p, size_t n, int t, int q);
-size_t select_sjf(Process *p, size_t n, int t, int pre);
-size_t select_priority(Process *p, size_t n, int t, int pre);
-void enqueue_arrivals(Process *p, size_t n, int t, bool *enq);
+// Prototips de les funcions auxiliars. run_generic() i run_specialized()
+// esperen la taula ordenada per arribada (run_dispatcher() l'ordena).
+// Totes dues produeixen la mateixa planificació: run_generic() és la
+// referència, que passa per la interfície de la política, i
+// run_specialized() executa un bucle compilat per a cada algorisme
+// predefinit, modalitat i cua (les altres polítiques fan servir el genèric).
+int run_generic(SimContext *ctx);
+int run_specialized(SimContext *ctx);
 
 #endif
@@ -0,0 +1,82 @@
+#include <string.h>
+#include <time.h>
+#include "stats.h"
+
+_Thread_local SimStats simStats;
+
+bool stats_enabled(void)
+{
+#ifdef SCHEDSIM_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Rellotge monòton en nanosegons
+uint64_t stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void stats_reset(void)
+{
+    memset(&simStats, 0, sizeof(SimStats));
+}
+
+// Suma els comptadors i temps de from a into (p.ex. els d'un fil)
+void stats_merge(SimStats *into, const SimStats *from)
+{
+    for (size_t c = 0; c < NUM_STAT_COUNTERS; c++)
+    {
+        into->counters[c] += from->counters[c];
+    }
+    for (size_t t = 0; t < NUM_STAT_TIMERS; t++)
+    {
+        into->ns[t] += from->ns[t];
+    }
+}
+
+// Temps de simulació per volta del bucle d'esdeveniments
+double stats_ns_per_event(const SimStats *s)
+{
+    uint64_t events = s->counters[STAT_ITERATIONS];
+    return events > 0 ? (double)s->ns[TIMER_RUN] / (double)events : 0;
+}
+
+// Reserves (al sistema i a l'arena) per procés de la taula
+double stats_allocs_per_proc(const SimStats *s, size_t nprocs)
+{
+    uint64_t allocs = s->counters[STAT_MALLOCS] + s->counters[STAT_ARENA_ALLOCS];
+    return nprocs > 0 ? (double)allocs / (double)nprocs : 0;
+}
+
+void writeStats(OutBuf *ob, const SimStats *s, size_t nprocs)
+{
+    outbuf_printf(ob, "%-14s", "== STATS ");
+    outbuf_repeat(ob, '=', 30);
+    outbuf_putc(ob, '\n');
+    if (!stats_enabled())
+    {
+        outbuf_puts(ob, "not compiled in (make clean && make STATS=1)\n");
+        return;
+    }
+    uint64_t events = s->counters[STAT_ITERATIONS];
+    for (size_t c = 0; c < NUM_STAT_COUNTERS; c++)
+    {
+        outbuf_printf(ob, "%-16s%14llu", statCountersNames[c], (unsigned long long)s->counters[c]);
+        if (events > 0 && c != STAT_ITERATIONS && c < STAT_LOAD_BYTES)
+        {
+            outbuf_printf(ob, "%10.3f/event", (double)s->counters[c] / (double)events);
+        }
+        outbuf_putc(ob, '\n');
+    }
+    for (size_t t = 0; t < NUM_STAT_TIMERS; t++)
+    {
+        outbuf_printf(ob, "%-16s%14.3f ms\n", statTimersNames[t], (double)s->ns[t] / 1e6);
+    }
+    outbuf_printf(ob, "%-16s%14.1f\n", "ns/event", stats_ns_per_event(s));
+    outbuf_printf(ob, "%-16s%14.3f\n", "allocs/process", stats_allocs_per_proc(s, nprocs));
+}
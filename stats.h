@@ -0,0 +1,101 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "outbuf.h"
+
+// Comptadors i temporitzadors del camí calent: bucle del motor, cues,
+// montícles, història dels processos, memòria i càrrega de la taula. Només
+// es compilen amb SCHEDSIM_STATS (make STATS=1, per defecte); sense, les
+// macros no generen cap codi. Cada fil té els seus comptadors, de manera
+// que les simulacions paral·leles del mode comparatiu no es trepitgen.
+enum statCounters{
+    STAT_ITERATIONS,        // voltes del bucle d'esdeveniments
+    STAT_SKIPPED,           // instants saltats sense cap esdeveniment
+    STAT_ARRIVALS,
+    STAT_WAKEUPS,           // finals d'E/S i alliberaments periòdics
+    STAT_DISPATCHES,
+    STAT_STEALS,
+    STAT_SLICE_ENDS,        // trams esgotats (quantum)
+    STAT_PREEMPTIONS,
+    STAT_BLOCKS,
+    STAT_COMPLETIONS,       // treballs acabats
+    STAT_ENQUEUES,          // cues FIFO
+    STAT_DEQUEUES,
+    STAT_QUEUE_GROWS,
+    STAT_HEAP_PUSHES,       // montícles (de preparats i de despertars)
+    STAT_HEAP_POPS,
+    STAT_HEAP_GROWS,
+    STAT_READY_PUSHES,      // ReadySet (-k scalar/simd)
+    STAT_READY_POPS,
+    STAT_SEGMENTS,          // trams nous a la història dels processos
+    STAT_MALLOCS,           // reserves al sistema (malloc/realloc)
+    STAT_ARENA_ALLOCS,      // reserves a l'arena
+    STAT_LOAD_BYTES,
+    STAT_LOAD_PROCS,
+};
+static const char * const statCountersNames[] = {
+	[STAT_ITERATIONS] = "iterations",
+	[STAT_SKIPPED] = "skipped",
+	[STAT_ARRIVALS] = "arrivals",
+	[STAT_WAKEUPS] = "wakeups",
+	[STAT_DISPATCHES] = "dispatches",
+	[STAT_STEALS] = "steals",
+	[STAT_SLICE_ENDS] = "slice_ends",
+	[STAT_PREEMPTIONS] = "preemptions",
+	[STAT_BLOCKS] = "blocks",
+	[STAT_COMPLETIONS] = "completions",
+	[STAT_ENQUEUES] = "enqueues",
+	[STAT_DEQUEUES] = "dequeues",
+	[STAT_QUEUE_GROWS] = "queue_grows",
+	[STAT_HEAP_PUSHES] = "heap_pushes",
+	[STAT_HEAP_POPS] = "heap_pops",
+	[STAT_HEAP_GROWS] = "heap_grows",
+	[STAT_READY_PUSHES] = "ready_pushes",
+	[STAT_READY_POPS] = "ready_pops",
+	[STAT_SEGMENTS] = "segments",
+	[STAT_MALLOCS] = "mallocs",
+	[STAT_ARENA_ALLOCS] = "arena_allocs",
+	[STAT_LOAD_BYTES] = "load_bytes",
+	[STAT_LOAD_PROCS] = "load_procs",
+};
+#define NUM_STAT_COUNTERS (sizeof(statCountersNames) / sizeof(char *))
+
+enum statTimers{TIMER_LOAD, TIMER_RUN};
+static const char * const statTimersNames[] = {
+	[TIMER_LOAD] = "load",
+	[TIMER_RUN] = "run",
+};
+#define NUM_STAT_TIMERS (sizeof(statTimersNames) / sizeof(char *))
+
+typedef struct _simstats
+{
+    uint64_t counters[NUM_STAT_COUNTERS];
+    uint64_t ns[NUM_STAT_TIMERS];
+} SimStats;
+
+extern _Thread_local SimStats simStats;
+
+#ifdef SCHEDSIM_STATS
+#define STATS_INC(c) (simStats.counters[c]++)
+#define STATS_ADD(c, n) (simStats.counters[c] += (uint64_t)(n))
+#define STATS_TIMER_START(name) uint64_t name = stats_now()
+#define STATS_TIMER_STOP(t, name) (simStats.ns[t] += stats_now() - (name))
+#else
+#define STATS_INC(c) ((void)0)
+#define STATS_ADD(c, n) ((void)0)
+#define STATS_TIMER_START(name) ((void)0)
+#define STATS_TIMER_STOP(t, name) ((void)0)
+#endif
+
+bool stats_enabled(void);
+uint64_t stats_now(void);
+void stats_reset(void);
+void stats_merge(SimStats *into, const SimStats *from);
+double stats_ns_per_event(const SimStats *s);
+double stats_allocs_per_proc(const SimStats *s, size_t nprocs);
+void writeStats(OutBuf *ob, const SimStats *s, size_t nprocs);
+
+#endif
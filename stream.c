@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stream.h"
+
+// La finestra és la més petita entre window (0: STREAM_WINDOW) i els
+// processos del generador. Tot el que es reserva és proporcional a la
+// finestra, no als processos.
+int init_stream(ProcStream *s, const Generator *gen, size_t window)
+{
+    memset(s, 0, sizeof(ProcStream));
+    s->gen = *gen;
+    window = window > 0 ? window : STREAM_WINDOW;
+    s->nslots = gen->nprocs < window ? gen->nprocs : window;
+    s->nslots = s->nslots > 0 ? s->nslots : 1;
+    size_t nbursts = 2 * (size_t)gen->cycles - 1;
+    s->slots = calloc(s->nslots, sizeof(Process));
+    s->bursts = malloc(s->nslots * nbursts * sizeof(int));
+    s->names = malloc(s->nslots * STREAM_NAME_SIZE);
+    s->free = malloc(s->nslots * sizeof(size_t));
+    s->nextBursts = malloc(nbursts * sizeof(int));
+    if (s->slots == NULL || s->bursts == NULL || s->names == NULL || s->free == NULL || s->nextBursts == NULL)
+    {
+        clean_stream(s);
+        return EXIT_FAILURE;
+    }
+    for (size_t p = 0; p < s->nslots; p++)
+    {
+        s->slots[p].name = s->names + p * STREAM_NAME_SIZE;
+        s->slots[p].name[0] = '\0';
+    }
+    return EXIT_SUCCESS;
+}
+
+// Torna a començar el generador i buida la finestra. L'arena de
+// l'execució també torna a començar: la història de les posicions ja no
+// hi és.
+void stream_start(ProcStream *s)
+{
+    resetGenerator(&s->gen);
+    for (size_t p = 0; p < s->nslots; p++)
+    {
+        s->slots[p].lifecycle = NULL;
+        s->slots[p].lifecycle_size = 0;
+        s->slots[p].lifecycle_capacity = 0;
+    }
+    s->fresh = 0;
+    s->nfree = 0;
+    s->pending = nextProcess(&s->gen, &s->next, s->nextBursts);
+}
+
+// Posa la següent arribada en una posició lliure i en genera una altra.
+// Retorna NULL si la finestra és plena. Si el generador s'atura per
+// desbordament del rellotge, s->gen.overflow ho indica.
+Process *stream_admit(ProcStream *s)
+{
+    size_t slot;
+    if (s->fresh < s->nslots)
+    {
+        slot = s->fresh++;
+    }
+    else if (s->nfree > 0)
+    {
+        slot = s->free[--s->nfree];
+    }
+    else
+    {
+        return NULL;
+    }
+    Process *p = &s->slots[slot];
+    // La posició conserva el nom, les ràfegues i la història reservats
+    char *name = p->name;
+    Segment *lifecycle = p->lifecycle;
+    size_t capacity = p->lifecycle_capacity;
+    *p = s->next;
+    p->name = name;
+    p->lifecycle = lifecycle;
+    p->lifecycle_size = 0;
+    p->lifecycle_capacity = capacity;
+    snprintf(name, STREAM_NAME_SIZE, "P%d", p->id);
+    int nbursts = 2 * s->gen.cycles - 1;
+    if (nbursts > 1)
+    {
+        int *bursts = s->bursts + slot * (size_t)nbursts;
+        memcpy(bursts, s->nextBursts, (size_t)nbursts * sizeof(int));
+        setBursts(p, bursts, nbursts);
+    }
+    s->pending = nextProcess(&s->gen, &s->next, s->nextBursts);
+    return p;
+}
+
+// p ha acabat: la seva posició pot rebre una altra arribada
+void stream_release(ProcStream *s, Process *p)
+{
+    s->free[s->nfree++] = (size_t)(p - s->slots);
+}
+
+void clean_stream(ProcStream *s)
+{
+    free(s->slots);
+    free(s->bursts);
+    free(s->names);
+    free(s->free);
+    free(s->nextBursts);
+    s->slots = NULL;
+    s->bursts = NULL;
+    s->names = NULL;
+    s->free = NULL;
+    s->nextBursts = NULL;
+}
@@ -0,0 +1,42 @@
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "process.h"
+#include "generator.h"
+
+// Processos vius alhora (arribats i no acabats) per defecte
+#define STREAM_WINDOW (1 << 16)
+#define STREAM_NAME_SIZE 16
+
+// Processos d'un generador consumits a mesura que arriben, sense construir
+// la taula. Cada procés viu ocupa una posició de slots, que és la taula
+// que veu el motor; quan acaba, la posició queda lliure per a una arribada
+// posterior, i la seva història (a l'arena de l'execució) es reaprofita.
+// Les posicions es fan servir per primer cop en ordre d'arribada: si tots
+// els processos hi caben, la taula és la mateixa que la materialitzada.
+// El generador va un procés per davant: el motor només en consulta
+// l'instant d'arribada fins que l'admet.
+typedef struct _procstream
+{
+    Generator gen;
+    Process *slots;
+    size_t nslots;
+    int *bursts;            // ràfegues de cada posició (2 * cycles - 1)
+    char *names;            // nom de cada posició (STREAM_NAME_SIZE)
+    size_t fresh;           // posicions que encara no s'han fet servir
+    size_t *free;           // posicions alliberades, com a pila
+    size_t nfree;
+    Process next;           // següent arribada, ja generada
+    int *nextBursts;
+    bool pending;           // next és vàlid
+} ProcStream;
+
+int init_stream(ProcStream *s, const Generator *gen, size_t window);
+void stream_start(ProcStream *s);
+Process *stream_admit(ProcStream *s);
+void stream_release(ProcStream *s, Process *p);
+void clean_stream(ProcStream *s);
+
+#endif
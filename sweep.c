@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "process.h"
+#include "scheduler.h"
+#include "sweep.h"
+#include "stats.h"
+
+// Feina compartida pels fils: cada fil agafa la següent configuració
+// pendent i la simula sobre una còpia privada de la taula o, amb un
+// generador, sobre el seu propi flux.
+typedef struct _sweepjob
+{
+    Process *procTable;
+    size_t nprocs;
+    const Generator *generator;
+    size_t window;
+    SimOptions *options;
+    SimResults *results;
+    int *status;
+    size_t nconfigs;
+    size_t next;
+    pthread_mutex_t lock;
+    SimStats stats;     // comptadors dels fils (--stats), sumats en acabar
+} SweepJob;
+
+int num_objectives()
+{
+    return sizeof(objectivesNames) / sizeof(char *);
+}
+
+static double objective(const SimResults *r, int obj)
+{
+    switch (obj)
+    {
+    case OBJ_RESPONSE:
+        return r->averageResponseTime;
+    case OBJ_RETURN:
+        return r->averageReturnTime;
+    case OBJ_RETURN_N:
+        return r->averageReturnTimeN;
+    case OBJ_DURATION:
+        return (double)r->duration;
+    case OBJ_P99_WAITING:
+        return r->p99WaitingTime;
+    case OBJ_P99_RESPONSE:
+        return r->p99ResponseTime;
+    case OBJ_MAX_WAITING:
+        return r->maxWaitingTime;
+    default:
+        return r->averageWaitingTime;
+    }
+}
+
+static void *sweepWorker(void *arg)
+{
+    SweepJob *job = arg;
+    Process *copy = NULL;
+    if (job->generator == NULL)
+    {
+        copy = malloc((job->nprocs > 0 ? job->nprocs : 1) * sizeof(Process));
+    }
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+        size_t i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->nconfigs)
+        {
+            break;
+        }
+        // Cada configuració té el seu propi context: cap estat compartit
+        SimContext ctx;
+        if (job->generator != NULL)
+        {
+            job->status[i] = init_generated_context(&ctx, job->generator, job->window, &job->options[i]);
+        }
+        else if (copy == NULL)
+        {
+            job->status[i] = EXIT_FAILURE;
+            continue;
+        }
+        else
+        {
+            memcpy(copy, job->procTable, job->nprocs * sizeof(Process));
+            job->status[i] = init_context(&ctx, copy, job->nprocs, &job->options[i]);
+        }
+        if (job->status[i] == EXIT_SUCCESS)
+        {
+            job->status[i] = run_dispatcher(&ctx);
+            job->results[i] = ctx.results;
+            clean_context(&ctx);
+        }
+    }
+    free(copy);
+    // Els comptadors són per fil: es sumen als de la feina
+    pthread_mutex_lock(&job->lock);
+    stats_merge(&job->stats, &simStats);
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+// Llista les configuracions del barrit, sense repetir les que el simulador
+// considera equivalents (una política que només admet una modalitat, com
+// FCFS o RR, s'executa sempre en aquesta).
+static size_t buildConfigs(const Sweep *sweep, SimOptions *options)
+{
+    size_t n = 0;
+    for (int a = 0; a < num_algorithms(); a++)
+    {
+        if (sweep->algorithm != SWEEP_ALL && sweep->algorithm != a)
+        {
+            continue;
+        }
+        const Policy *policy = get_policy(a);
+        bool single = !policy_accepts(policy, PREEMPTIVE) || !policy_accepts(policy, NONPREEMPTIVE);
+        for (int m = 0; m < num_modalities(); m++)
+        {
+            if (sweep->modality != SWEEP_ALL && sweep->modality != m)
+            {
+                continue;
+            }
+            // Amb una sola modalitat, una sola passada
+            if (single && sweep->modality == SWEEP_ALL && m > 0)
+            {
+                continue;
+            }
+            int modality = policy_modality(policy, m);
+            int qmin = policy->quantum ? sweep->quantum_min : 0;
+            int qmax = policy->quantum ? sweep->quantum_max : 0;
+            for (int q = qmin; q <= qmax; q++)
+            {
+                if (options != NULL)
+                {
+                    SimOptions o = {a, modality, q, sweep->cpus, true};
+                    o.backend = sweep->backend;
+                    o.seed = sweep->seed;
+                    o.horizon = sweep->horizon;
+                    o.aging = sweep->aging;
+                    options[n] = o;
+                }
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+int run_sweep(Process *procTable, size_t nprocs, const Sweep *sweep)
+{
+    size_t nconfigs = buildConfigs(sweep, NULL);
+    SweepJob job;
+    job.options = malloc((nconfigs > 0 ? nconfigs : 1) * sizeof(SimOptions));
+    job.results = calloc(nconfigs > 0 ? nconfigs : 1, sizeof(SimResults));
+    job.status = calloc(nconfigs > 0 ? nconfigs : 1, sizeof(int));
+    size_t *order = malloc((nconfigs > 0 ? nconfigs : 1) * sizeof(size_t));
+    if (job.options == NULL || job.results == NULL || job.status == NULL || order == NULL)
+    {
+        free(job.options);
+        free(job.results);
+        free(job.status);
+        free(order);
+        return EXIT_FAILURE;
+    }
+    buildConfigs(sweep, job.options);
+
+    // S'ordena una sola vegada; cada còpia ja parteix de la taula ordenada
+    if (sweep->generator == NULL && sortByArrival(procTable, nprocs) != EXIT_SUCCESS)
+    {
+        free(job.options);
+        free(job.results);
+        free(job.status);
+        free(order);
+        return EXIT_FAILURE;
+    }
+    job.procTable = procTable;
+    job.nprocs = sweep->generator != NULL ? sweep->generator->nprocs : nprocs;
+    job.generator = sweep->generator;
+    job.window = sweep->window;
+    job.nconfigs = nconfigs;
+    job.next = 0;
+    memset(&job.stats, 0, sizeof(SimStats));
+    pthread_mutex_init(&job.lock, NULL);
+
+    long nthreads = sweep->threads > 0 ? sweep->threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads < 1)
+    {
+        nthreads = 1;
+    }
+    if ((size_t)nthreads > nconfigs)
+    {
+        nthreads = (long)(nconfigs > 0 ? nconfigs : 1);
+    }
+    pthread_t *threads = malloc((size_t)nthreads * sizeof(pthread_t));
+    long started = 0;
+    while (threads != NULL && started < nthreads && pthread_create(&threads[started], NULL, sweepWorker, &job) == 0)
+    {
+        started++;
+    }
+    if (started == 0)
+    {
+        sweepWorker(&job);
+    }
+    for (long i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    // Sense fils, la feina s'ha fet (i comptat) en aquest mateix
+    if (started > 0)
+    {
+        stats_merge(&simStats, &job.stats);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job.lock);
+
+    // Ordenació per l'objectiu triat; a igualtat es manté l'ordre de la llista
+    for (size_t i = 0; i < nconfigs; i++)
+    {
+        order[i] = i;
+    }
+    for (size_t i = 1; i < nconfigs; i++)
+    {
+        size_t current = order[i];
+        double value = objective(&job.results[current], sweep->objective);
+        size_t j = i;
+        while (j > 0 && objective(&job.results[order[j - 1]], sweep->objective) > value)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = current;
+    }
+
+    printf("== SWEEP %zu configurations, %zu processes, sorted by %s\n", nconfigs, job.nprocs, objectivesNames[sweep->objective]);
+    printf("|%-11s|%-14s|%4s|%10s|%12s|%12s|%12s|%12s|%12s|%12s|%12s|%10s|%8s|\n", "algorithm", "modality", "q",
+           "duration", "waiting", "p99waiting", "maxwait", "response", "p99response", "return", "returnN", "throughput",
+           "cpu");
+    int status = EXIT_SUCCESS;
+    for (size_t i = 0; i < nconfigs; i++)
+    {
+        SimOptions *o = &job.options[order[i]];
+        SimResults *r = &job.results[order[i]];
+        if (job.status[order[i]] != EXIT_SUCCESS)
+        {
+            printf("|%-11s|%-14s|%4d| failed\n", algorithm_name(o->algorithm), modalitiesNames[o->modality], o->quantum);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        char q[16] = "-";
+        if (get_policy(o->algorithm)->quantum)
+        {
+            snprintf(q, sizeof(q), "%d", o->quantum);
+        }
+        printf("|%-11s|%-14s|%4s|%10zu|%12.3lf|%12.3lf|%12.3lf|%12.3lf|%12.3lf|%12.3lf|%12.3lf|%10.4lf|%7.2lf%%|\n",
+               algorithm_name(o->algorithm), modalitiesNames[o->modality], q, r->duration,
+               r->averageWaitingTime, r->p99WaitingTime, r->maxWaitingTime, r->averageResponseTime, r->p99ResponseTime,
+               r->averageReturnTime, r->averageReturnTimeN,
+               r->throughput, r->cpuUsage * 100);
+    }
+
+    free(job.options);
+    free(job.results);
+    free(job.status);
+    free(order);
+    return status;
+}
@@ -0,0 +1,45 @@
+#ifndef _SWEEP_H_
+#define _SWEEP_H_
+
+#include "process.h"
+#include "scheduler.h"
+
+# define SWEEP_ALL -1
+
+// Mètrica per la qual s'ordena la taula comparativa (menor és millor)
+enum objectives{OBJ_WAITING, OBJ_RESPONSE, OBJ_RETURN, OBJ_RETURN_N, OBJ_DURATION, OBJ_P99_WAITING, OBJ_P99_RESPONSE,
+                OBJ_MAX_WAITING};
+static const char * const objectivesNames[] = {
+	[OBJ_WAITING] = "waiting",
+	[OBJ_RESPONSE] = "response",
+	[OBJ_RETURN] = "return",
+	[OBJ_RETURN_N] = "returnN",
+	[OBJ_DURATION] = "duration",
+	[OBJ_P99_WAITING] = "p99waiting",
+	[OBJ_P99_RESPONSE] = "p99response",
+	[OBJ_MAX_WAITING] = "maxwait",
+};
+
+// Conjunt de configuracions a comparar. algorithm/modality poden ser
+// SWEEP_ALL; el rang de quantum només s'aplica a les polítiques amb quantum.
+typedef struct _sweep
+{
+    int algorithm;
+    int modality;
+    int quantum_min;
+    int quantum_max;
+    CPUConfig cpus;
+    int objective;
+    int threads;        // 0: un per processador de la màquina
+    int backend;        // cua de preparats de SJF/Prioritats/EDF/RM
+    uint64_t seed;      // llavor de les polítiques aleatòries
+    int horizon;        // últim alliberament de les tasques periòdiques (0: l'hiperperíode)
+    int aging;          // envelliment de Prioritats (0: cap)
+    const Generator *generator; // no NULL: cada configuració consumeix el generador en flux, sense taula
+    size_t window;      // processos vius del flux (0: STREAM_WINDOW)
+} Sweep;
+
+int num_objectives(void);
+int run_sweep(Process *procTable, size_t nprocs, const Sweep *sweep);
+
+#endif